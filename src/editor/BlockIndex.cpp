@@ -0,0 +1,116 @@
+#include "BlockIndex.h"
+
+#include <algorithm>
+
+static const BlockIndex::Summary EmptySummary = { 0, BlockIndex::None, BlockIndex::None };
+
+BlockIndex::BlockIndex()
+  : mSize( 0 )
+  , mLeaves( 1 ) {
+  mNodes.assign( 2, EmptySummary );
+}
+
+BlockIndex::Summary BlockIndex::Combine( const Summary &aLeft, const Summary &aRight ) {
+  return {
+    aLeft.mDelta + aRight.mDelta,
+    std::min( aLeft.mMinBefore, aLeft.mDelta + aRight.mMinBefore ),
+    std::min( aLeft.mMinAfter, aLeft.mDelta + aRight.mMinAfter )
+  };
+}
+
+void BlockIndex::Assign( const std::vector<Summary> &aLines ) {
+  mSize = ( int )aLines.size();
+  mLeaves = 1;
+
+  while( mLeaves < mSize ) {
+    mLeaves *= 2;
+  }
+
+  mNodes.assign( mLeaves * 2, EmptySummary );
+  std::copy( aLines.begin(), aLines.end(), mNodes.begin() + mLeaves );
+
+  for( int node = mLeaves - 1; node > 0; --node ) {
+    mNodes[node] = Combine( mNodes[node * 2], mNodes[node * 2 + 1] );
+  }
+}
+
+void BlockIndex::Update( int aLine, const Summary &aSummary ) {
+  if( aLine < 0 || aLine >= mSize ) {
+    return;
+  }
+
+  int node = mLeaves + aLine;
+  mNodes[node] = aSummary;
+
+  for( node /= 2; node > 0; node /= 2 ) {
+    mNodes[node] = Combine( mNodes[node * 2], mNodes[node * 2 + 1] );
+  }
+}
+
+int BlockIndex::DepthBefore( int aLine ) const {
+  if( aLine <= 0 ) {
+    return 0;
+  }
+
+  if( aLine >= mLeaves ) {
+    return mNodes[1].mDelta;
+  }
+
+  int depth = 0;
+
+  // Sum the left siblings on the way up from the leaf
+  for( int node = mLeaves + aLine; node > 1; node /= 2 ) {
+    if( node & 1 ) {
+      depth += mNodes[node - 1].mDelta;
+    }
+  }
+
+  return depth;
+}
+
+int BlockIndex::FindClosing( int aFrom, int aDepth ) const {
+  return aFrom >= mSize ? -1 : FindClosing( 1, 0, mLeaves, std::max( 0, aFrom ), aDepth, 0 );
+}
+
+int BlockIndex::FindOpening( int aTo, int aDepth ) const {
+  return aTo < 0 ? -1 : FindOpening( 1, 0, mLeaves, std::min( aTo, mSize - 1 ), aDepth, 0 );
+}
+
+// aStart is the depth at the start of the node's range
+int BlockIndex::FindClosing( int aNode, int aBegin, int aEnd, int aFrom, int aDepth, int aStart ) const {
+  if( aEnd <= aFrom || ( aBegin >= aFrom && aStart + mNodes[aNode].mMinAfter >= aDepth ) ) {
+    return -1;
+  }
+
+  if( aEnd - aBegin == 1 ) {
+    return aBegin;
+  }
+
+  int middle = ( aBegin + aEnd ) / 2;
+  int line = FindClosing( aNode * 2, aBegin, middle, aFrom, aDepth, aStart );
+
+  if( line < 0 ) {
+    line = FindClosing( aNode * 2 + 1, middle, aEnd, aFrom, aDepth, aStart + mNodes[aNode * 2].mDelta );
+  }
+
+  return line;
+}
+
+int BlockIndex::FindOpening( int aNode, int aBegin, int aEnd, int aTo, int aDepth, int aStart ) const {
+  if( aBegin > aTo || ( aEnd - 1 <= aTo && aStart + mNodes[aNode].mMinBefore >= aDepth ) ) {
+    return -1;
+  }
+
+  if( aEnd - aBegin == 1 ) {
+    return aBegin;
+  }
+
+  int middle = ( aBegin + aEnd ) / 2;
+  int line = FindOpening( aNode * 2 + 1, middle, aEnd, aTo, aDepth, aStart + mNodes[aNode * 2].mDelta );
+
+  if( line < 0 ) {
+    line = FindOpening( aNode * 2, aBegin, middle, aTo, aDepth, aStart );
+  }
+
+  return line;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+// Nesting depth of the brackets and blocks of a document, summed per line in
+// a segment tree. A line is reduced to its depth change and the lowest depths
+// it reaches, which is enough to find the line where a block opens or closes
+// by visiting O(log n) nodes instead of scanning the text in between.
+class BlockIndex {
+ public:
+  static constexpr int None = 1 << 29;
+
+  // Depths are relative to the start of the line, the minimums are taken right
+  // before and right after each of its tokens (None when there are none)
+  struct Summary {
+    int mDelta;
+    int mMinBefore;
+    int mMinAfter;
+  };
+
+  BlockIndex();
+
+  void Assign( const std::vector<Summary> &aLines );
+  void Update( int aLine, const Summary &aSummary );
+
+  inline int GetSize() const {
+    return mSize;
+  }
+
+  // Depth at the start of aLine
+  int DepthBefore( int aLine ) const;
+
+  // First line from aFrom on where the depth drops below aDepth after a token
+  int FindClosing( int aFrom, int aDepth ) const;
+
+  // Last line up to aTo where the depth is below aDepth before a token
+  int FindOpening( int aTo, int aDepth ) const;
+
+ private:
+  static Summary Combine( const Summary &aLeft, const Summary &aRight );
+
+  int FindClosing( int aNode, int aBegin, int aEnd, int aFrom, int aDepth, int aStart ) const;
+  int FindOpening( int aNode, int aBegin, int aEnd, int aTo, int aDepth, int aStart ) const;
+
+  int mSize;
+  int mLeaves;
+  std::vector<Summary> mNodes;
+};
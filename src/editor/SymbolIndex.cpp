@@ -0,0 +1,221 @@
+#include "SymbolIndex.h"
+
+#include <cassert>
+
+// References pack the entry index and the kind it was added as
+static const int KindBits = 3;
+
+SymbolIndex::SymbolIndex() {
+  Clear();
+}
+
+void SymbolIndex::Clear() {
+  mNodes.clear();
+  mEntries.clear();
+  mFreeNodes.clear();
+  mFreeEntries.clear();
+  mNodes.push_back( { None, None, None, None, 0, '\0' } );
+}
+
+void SymbolIndex::Add( const char *aBegin, const char *aEnd, Kind aKind, References &aReferences ) {
+  if( aBegin == aEnd ) {
+    return;
+  }
+
+  auto entry = InsertEntry( aBegin, aEnd );
+  ++mEntries[entry].mCounts[( int )aKind];
+  AddLive( mEntries[entry].mNode, 1 );
+  aReferences.push_back( entry << KindBits | ( uint32_t )aKind );
+}
+
+void SymbolIndex::Release( References &aReferences ) {
+  for( auto reference : aReferences ) {
+    auto entry = reference >> KindBits;
+    auto &count = mEntries[entry].mCounts[reference & ( ( 1 << KindBits ) - 1 )];
+    assert( count > 0 );
+    --count;
+    AddLive( mEntries[entry].mNode, -1 );
+    Prune( entry );
+  }
+
+  aReferences.clear();
+}
+
+void SymbolIndex::AddBuiltin( const std::string &aWord, Kind aKind, const std::string *aDeclaration ) {
+  if( aWord.empty() ) {
+    return;
+  }
+
+  auto index = InsertEntry( aWord.data(), aWord.data() + aWord.size() );
+  auto &entry = mEntries[index];
+  ++entry.mCounts[( int )aKind];
+  AddLive( entry.mNode, 1 );
+
+  if( aDeclaration != nullptr ) {
+    entry.mDeclaration = aDeclaration;
+  }
+}
+
+const std::string *SymbolIndex::FindDeclaration( const char *aBegin, const char *aEnd ) const {
+  auto node = FindNode( aBegin, aEnd );
+
+  if( node == None || mNodes[node].mEntry == None ) {
+    return nullptr;
+  }
+
+  return mEntries[mNodes[node].mEntry].mDeclaration;
+}
+
+void SymbolIndex::Complete( const char *aBegin, const char *aEnd, size_t aMax, std::vector<Completion> &aResults ) const {
+  auto node = FindNode( aBegin, aEnd );
+
+  if( node == None || mNodes[node].mLive == 0 ) {
+    return;
+  }
+
+  std::string word( aBegin, aEnd );
+  Collect( node, word, aMax, aResults );
+}
+
+uint32_t SymbolIndex::FindNode( const char *aBegin, const char *aEnd ) const {
+  uint32_t node = 0;
+
+  for( auto p = aBegin; p != aEnd && node != None; ++p ) {
+    node = mNodes[node].mChild;
+
+    while( node != None && mNodes[node].mChar < *p ) {
+      node = mNodes[node].mNext;
+    }
+
+    if( node != None && mNodes[node].mChar != *p ) {
+      node = None;
+    }
+  }
+
+  return node;
+}
+
+uint32_t SymbolIndex::InsertEntry( const char *aBegin, const char *aEnd ) {
+  uint32_t node = 0;
+
+  for( auto p = aBegin; p != aEnd; ++p ) {
+    // Walk the sorted siblings keeping the one before, indices stay valid when NewNode() grows the nodes
+    uint32_t previous = None;
+    uint32_t child = mNodes[node].mChild;
+
+    while( child != None && mNodes[child].mChar < *p ) {
+      previous = child;
+      child = mNodes[child].mNext;
+    }
+
+    if( child == None || mNodes[child].mChar != *p ) {
+      child = NewNode( node, child, *p );
+
+      if( previous == None ) {
+        mNodes[node].mChild = child;
+      } else {
+        mNodes[previous].mNext = child;
+      }
+    }
+
+    node = child;
+  }
+
+  if( mNodes[node].mEntry == None ) {
+    uint32_t entry;
+
+    if( mFreeEntries.empty() ) {
+      entry = ( uint32_t )mEntries.size();
+      mEntries.push_back( Entry() );
+    } else {
+      entry = mFreeEntries.back();
+      mFreeEntries.pop_back();
+      mEntries[entry] = Entry();
+    }
+
+    mEntries[entry].mNode = node;
+    mNodes[node].mEntry = entry;
+  }
+
+  return mNodes[node].mEntry;
+}
+
+uint32_t SymbolIndex::NewNode( uint32_t aParent, uint32_t aNext, char aChar ) {
+  Node node = { None, aNext, aParent, None, 0, aChar };
+
+  if( mFreeNodes.empty() ) {
+    mNodes.push_back( node );
+    return ( uint32_t )mNodes.size() - 1;
+  }
+
+  auto index = mFreeNodes.back();
+  mFreeNodes.pop_back();
+  mNodes[index] = node;
+  return index;
+}
+
+// Counts a reference on aNode and every node above it
+void SymbolIndex::AddLive( uint32_t aNode, int aDelta ) {
+  for( auto node = aNode; node != None; node = mNodes[node].mParent ) {
+    mNodes[node].mLive += aDelta;
+  }
+}
+
+// Frees aEntry once nothing refers to it anymore, and the nodes that only led to it
+void SymbolIndex::Prune( uint32_t aEntry ) {
+  auto node = mEntries[aEntry].mNode;
+
+  if( mEntries[aEntry].mDeclaration != nullptr ) {
+    return;
+  }
+
+  for( auto count : mEntries[aEntry].mCounts ) {
+    if( count > 0 ) {
+      return;
+    }
+  }
+
+  mNodes[node].mEntry = None;
+  mFreeEntries.push_back( aEntry );
+
+  while( node != 0 && mNodes[node].mEntry == None && mNodes[node].mChild == None ) {
+    auto parent = mNodes[node].mParent;
+    auto *link = &mNodes[parent].mChild;
+
+    while( *link != node ) {
+      link = &mNodes[*link].mNext;
+    }
+
+    *link = mNodes[node].mNext;
+    mFreeNodes.push_back( node );
+    node = parent;
+  }
+}
+
+void SymbolIndex::Collect( uint32_t aNode, std::string &aWord, size_t aMax, std::vector<Completion> &aResults ) const {
+  if( aResults.size() >= aMax ) {
+    return;
+  }
+
+  if( mNodes[aNode].mEntry != None ) {
+    auto &entry = mEntries[mNodes[aNode].mEntry];
+
+    for( int kind = ( int )Kind::Max - 1; kind >= 0; --kind ) {
+      if( entry.mCounts[kind] > 0 ) {
+        aResults.push_back( { aWord, ( Kind )kind } );
+        break;
+      }
+    }
+  }
+
+  // Subtrees without references only hold words of released lines
+  for( auto child = mNodes[aNode].mChild; child != None; child = mNodes[child].mNext ) {
+    if( mNodes[child].mLive == 0 ) {
+      continue;
+    }
+
+    aWord.push_back( mNodes[child].mChar );
+    Collect( child, aWord, aMax, aResults );
+    aWord.pop_back();
+  }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Prefix trie over the words of a document, used for autocomplete and hover
+// lookups. Every word is reference counted per kind, so a line can be
+// re-indexed on its own by releasing what it added before and adding it again.
+class SymbolIndex {
+ public:
+  // Ordered by how interesting a kind is when completing, most specific last
+  enum class Kind : uint8_t {
+    Identifier,
+    Keyword,
+    Builtin,
+    Member,
+    Global,
+    Local,
+    Max
+  };
+
+  struct Completion {
+    std::string mWord;
+    Kind mKind;
+  };
+
+  // The words one line added to the index, handed back to Release()
+  typedef std::vector<uint32_t> References;
+
+  SymbolIndex();
+
+  void Clear();
+
+  void Add( const char *aBegin, const char *aEnd, Kind aKind, References &aReferences );
+  void Release( References &aReferences );
+
+  // Builtins are never released, aDeclaration must outlive the index
+  void AddBuiltin( const std::string &aWord, Kind aKind, const std::string *aDeclaration = nullptr );
+
+  const std::string *FindDeclaration( const char *aBegin, const char *aEnd ) const;
+
+  // Collects up to aMax words starting with the prefix, in alphabetical order
+  void Complete( const char *aBegin, const char *aEnd, size_t aMax, std::vector<Completion> &aResults ) const;
+
+ private:
+  static constexpr uint32_t None = ~0u;
+
+  // First child / next sibling layout, siblings are sorted by character
+  struct Node {
+    uint32_t mChild;
+    uint32_t mNext;
+    uint32_t mParent;
+    uint32_t mEntry;
+    uint32_t mLive;   // counts of the entries in this subtree, 0 when there's nothing to complete
+    char mChar;
+  };
+
+  struct Entry {
+    uint32_t mCounts[( int )Kind::Max];
+    const std::string *mDeclaration;
+    uint32_t mNode;
+  };
+
+  uint32_t FindNode( const char *aBegin, const char *aEnd ) const;
+  uint32_t InsertEntry( const char *aBegin, const char *aEnd );
+  uint32_t NewNode( uint32_t aParent, uint32_t aNext, char aChar );
+  void AddLive( uint32_t aNode, int aDelta );
+  void Prune( uint32_t aEntry );
+  void Collect( uint32_t aNode, std::string &aWord, size_t aMax, std::vector<Completion> &aResults ) const;
+
+  std::vector<Node> mNodes;
+  std::vector<Entry> mEntries;
+
+  // Released nodes and entries, reused before growing the vectors
+  std::vector<uint32_t> mFreeNodes;
+  std::vector<uint32_t> mFreeEntries;
+};
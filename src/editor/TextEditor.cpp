@@ -3,6 +3,7 @@
 #include <string>
 #include <regex>
 #include <cmath>
+#include <climits>
 
 #include "TextEditor.h"
 
@@ -24,6 +25,10 @@ bool equals( InputIt1 first1, InputIt1 last1,
   return first1 == last1 && first2 == last2;
 }
 
+static bool IsIdentifierChar( char aChar ) {
+  return isalnum( ( unsigned char )aChar ) || aChar == '_';
+}
+
 TextEditor::TextEditor()
   : mLineSpacing( 1.0f )
   , mUndoIndex( 0 )
@@ -47,6 +52,30 @@ TextEditor::TextEditor()
   , mHandleMouseInputs( true )
   , mIgnoreImGuiChild( false )
   , mShowWhitespaces( true )
+  , mShowMinimap( false )
+  , mRetained( false )
+  , mMinimapDragging( false )
+  , mMinimapWidth( 80.0f )
+  , mMinimapScale( 0.0f )
+  , mTextVersion( 0 )
+  , mCompletionOpen( false )
+  , mCompletionIndex( 0 )
+  , mWordWrap( false )
+  , mWrapWidth( 0.0f )
+  , mWrapFontSize( 0.0f )
+  , mWrapDirtyFrom( 0 )
+  , mBlocksDirty( true )
+  , mBlockVersion( 0 )
+  , mMatchVersion( ~0u )
+  , mMatchFound( false )
+  , mGuideFirst( -1 )
+  , mGuideLast( -1 )
+  , mGuideVersion( ~0u )
+  , mHoverRow( -1 )
+  , mHoverVersion( 0 )
+  , mHoverStart( 0.0f )
+  , mHoverEnd( 0.0f )
+  , mHoverDeclaration( nullptr )
   , mStartTime( std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::system_clock::now().time_since_epoch() ).count() ) {
   SetPalette( GetDarkPalette() );
   SetLanguageDefinition( LanguageDefinition::Lua() );
@@ -64,6 +93,7 @@ void TextEditor::SetLanguageDefinition( const LanguageDefinition &aLanguageDef )
     mRegexList.push_back( std::make_pair( std::regex( r.first, std::regex_constants::optimize ), r.second ) );
   }
 
+  ResetSymbols();
   Colorize();
 }
 
@@ -318,17 +348,21 @@ TextEditor::Coordinates TextEditor::ScreenPosToCoordinates( const ImVec2 &aPosit
   ImVec2 origin = ImGui::GetCursorScreenPos();
   ImVec2 local( aPosition.x - origin.x, aPosition.y - origin.y );
 
-  int lineNo = std::max( 0, ( int )floor( local.y / mCharAdvance.y ) );
+  int row = std::max( 0, ( int )floor( local.y / mCharAdvance.y ) );
+  int lineNo = GetRowLine( row );
 
   int columnCoord = 0;
 
   if( lineNo >= 0 && lineNo < ( int )mLines.size() ) {
     auto &line = mLines.at( lineNo );
 
-    int columnIndex = 0;
+    // Only the glyphs of the row under the position are considered
+    int columnIndex = GetRowBegin( line, row - GetLineRow( lineNo ) );
+    int columnEnd = GetRowEnd( line, row - GetLineRow( lineNo ) );
     float columnX = 0.0f;
+    columnCoord = GetCharacterColumn( lineNo, columnIndex );
 
-    while( ( size_t )columnIndex < line.size() ) {
+    while( columnIndex < columnEnd ) {
       float columnWidth = 0.0f;
 
       if( line[columnIndex].mChar == '\t' ) {
@@ -631,9 +665,15 @@ void TextEditor::RemoveLine( int aStart, int aEnd ) {
 
   mBreakpoints = std::move( btmp );
 
+  for( int i = aStart; i < aEnd; ++i ) {
+    mSymbolIndex.Release( mLines[i].mSymbols );
+  }
+
   mLines.erase( mLines.begin() + aStart, mLines.begin() + aEnd );
   assert( !mLines.empty() );
 
+  mWrapDirtyFrom = std::min( mWrapDirtyFrom, aStart );
+  mBlocksDirty = true;
   mTextChanged = true;
 }
 
@@ -667,9 +707,12 @@ void TextEditor::RemoveLine( int aIndex ) {
 
   mBreakpoints = std::move( btmp );
 
+  mSymbolIndex.Release( mLines[aIndex].mSymbols );
   mLines.erase( mLines.begin() + aIndex );
   assert( !mLines.empty() );
 
+  mWrapDirtyFrom = std::min( mWrapDirtyFrom, aIndex );
+  mBlocksDirty = true;
   mTextChanged = true;
 }
 
@@ -677,6 +720,8 @@ TextEditor::Line &TextEditor::InsertLine( int aIndex ) {
   assert( !mReadOnly );
 
   auto &result = *mLines.insert( mLines.begin() + aIndex, Line() );
+  mWrapDirtyFrom = std::min( mWrapDirtyFrom, aIndex );
+  mBlocksDirty = true;
 
   ErrorMarkers etmp;
 
@@ -718,6 +763,137 @@ std::string TextEditor::GetWordAt( const Coordinates &aCoords ) const {
   return r;
 }
 
+// Hovering usually stays on one word for many frames, so its bounds are kept
+// along with the line version and the lookup only runs once the mouse leaves them
+const std::string *TextEditor::FindDeclarationAt( const ImVec2 &aPosition ) {
+  auto origin = ImGui::GetCursorScreenPos();
+  auto x = aPosition.x - origin.x;
+  auto row = ( int )floor( ( aPosition.y - origin.y ) / mCharAdvance.y );
+  auto lineNo = GetRowLine( row );
+
+  if( row >= 0 && row == mHoverRow && lineNo < ( int )mLines.size() && mLines[lineNo].mVersion == mHoverVersion && x >= mHoverStart && x < mHoverEnd ) {
+    return mHoverDeclaration;
+  }
+
+  auto coords = ScreenPosToCoordinates( aPosition );
+  auto &line = mLines[coords.mLine];
+  auto start = FindWordStart( coords );
+  auto end = FindWordEnd( coords );
+  std::string word;
+
+  for( auto it = GetCharacterIndex( start ); it < GetCharacterIndex( end ); ++it ) {
+    word.push_back( line[it].mChar );
+  }
+
+  mHoverRow = row;
+  mHoverVersion = line.mVersion;
+  mHoverStart = mTextStart + TextDistanceToLineStart( start );
+  mHoverEnd = mTextStart + TextDistanceToLineStart( end );
+  mHoverDeclaration = word.empty() ? nullptr : mSymbolIndex.FindDeclaration( word.data(), word.data() + word.size() );
+
+  return mHoverDeclaration;
+}
+
+// The prefix is the part of an identifier right before the cursor
+void TextEditor::UpdateCompletion() {
+  mCompletions.clear();
+  mCompletionIndex = 0;
+  mCompletionOpen = false;
+
+  if( HasSelection() ) {
+    return;
+  }
+
+  auto cursor = GetActualCursorCoordinates();
+  auto &line = mLines[cursor.mLine];
+  auto end = GetCharacterIndex( cursor );
+  auto start = end;
+
+  while( start > 0 && IsIdentifierChar( line[start - 1].mChar ) ) {
+    --start;
+  }
+
+  if( start == end || isdigit( ( unsigned char )line[start].mChar ) ) {
+    return;
+  }
+
+  std::string prefix;
+
+  for( auto it = start; it < end; ++it ) {
+    prefix.push_back( line[it].mChar );
+  }
+
+  mSymbolIndex.Complete( prefix.data(), prefix.data() + prefix.size(), 16, mCompletions );
+
+  // The word being typed is in the index as well
+  mCompletions.erase( std::remove_if( mCompletions.begin(), mCompletions.end(), [&prefix]( const SymbolIndex::Completion & aCompletion ) {
+    return aCompletion.mWord == prefix;
+  } ), mCompletions.end() );
+
+  mCompletionOpen = !mCompletions.empty();
+}
+
+void TextEditor::AcceptCompletion() {
+  mCompletionOpen = false;
+
+  if( mCompletionIndex < 0 || mCompletionIndex >= ( int )mCompletions.size() ) {
+    return;
+  }
+
+  auto cursor = GetActualCursorCoordinates();
+  auto &line = mLines[cursor.mLine];
+  auto end = GetCharacterIndex( cursor );
+  auto start = end;
+
+  while( start > 0 && IsIdentifierChar( line[start - 1].mChar ) ) {
+    --start;
+  }
+
+  auto &word = mCompletions[mCompletionIndex].mWord;
+
+  if( ( size_t )( end - start ) >= word.size() ) {
+    return;
+  }
+
+  // One edit and one undo record for the whole rest of the word, like Paste()
+  auto suffix = word.substr( end - start );
+  UndoRecord u;
+  u.mBefore = mState;
+
+  if( HasSelection() ) {
+    u.mRemoved = GetSelectedText();
+    u.mRemovedStart = mState.mSelectionStart;
+    u.mRemovedEnd = mState.mSelectionEnd;
+    DeleteSelection();
+  }
+
+  u.mAdded = suffix;
+  u.mAddedStart = GetActualCursorCoordinates();
+
+  InsertText( suffix );
+
+  u.mAddedEnd = GetActualCursorCoordinates();
+  u.mAfter = mState;
+  AddUndo( u );
+}
+
+void TextEditor::RenderCompletion( const ImVec2 &aCursorScreenPos ) {
+  static const char *const kindNames[] = { "", "keyword", "builtin", "member", "global", "local" };
+
+  auto cursor = GetActualCursorCoordinates();
+  ImGui::SetNextWindowPos( ImVec2( aCursorScreenPos.x + mTextStart + TextDistanceToLineStart( cursor ), aCursorScreenPos.y + ( GetCoordinatesRow( cursor ) + 1 ) * mCharAdvance.y ) );
+  ImGui::BeginTooltip();
+
+  for( int i = 0; i < ( int )mCompletions.size(); ++i ) {
+    auto &completion = mCompletions[i];
+    ImGui::Selectable( completion.mWord.c_str(), i == mCompletionIndex );
+    ImGui::SameLine( 0.0f, mCharAdvance.x * 2.0f );
+    ImGui::TextDisabled( "%s", kindNames[( int )completion.mKind] );
+  }
+
+  ImGui::EndTooltip();
+}
+
 ImU32 TextEditor::GetGlyphColor( const Glyph &aGlyph ) const {
   if( !mColorizerEnabled ) {
     return mPalette[( int )PaletteIndex::Default];
@@ -761,7 +937,18 @@ void TextEditor::HandleKeyboardInputs() {
     io.WantCaptureKeyboard = true;
     io.WantTextInput = true;
 
-    if( !IsReadOnly() && ctrl && !shift && !alt && ImGui::IsKeyPressed( ImGui::GetKeyIndex( ImGuiKey_Z ) ) ) {
+    auto cursor = GetCursorPosition();
+    auto typed = false;
+
+    if( mCompletionOpen && !ctrl && !shift && !alt && ImGui::IsKeyPressed( ImGui::GetKeyIndex( ImGuiKey_UpArrow ) ) ) {
+      mCompletionIndex = ( mCompletionIndex + ( int )mCompletions.size() - 1 ) % ( int )mCompletions.size();
+    } else if( mCompletionOpen && !ctrl && !shift && !alt && ImGui::IsKeyPressed( ImGui::GetKeyIndex( ImGuiKey_DownArrow ) ) ) {
+      mCompletionIndex = ( mCompletionIndex + 1 ) % ( int )mCompletions.size();
+    } else if( mCompletionOpen && !ctrl && !shift && !alt && ( ImGui::IsKeyPressed( ImGui::GetKeyIndex( ImGuiKey_Tab ) ) || ImGui::IsKeyPressed( ImGui::GetKeyIndex( ImGuiKey_Enter ) ) ) ) {
+      AcceptCompletion();
+    } else if( mCompletionOpen && ImGui::IsKeyPressed( ImGui::GetKeyIndex( ImGuiKey_Escape ) ) ) {
+      mCompletionOpen = false;
+    } else if( !IsReadOnly() && ctrl && !shift && !alt && ImGui::IsKeyPressed( ImGui::GetKeyIndex( ImGuiKey_Z ) ) ) {
       Undo();
     } else if( !IsReadOnly() && !ctrl && !shift && alt && ImGui::IsKeyPressed( ImGui::GetKeyIndex( ImGuiKey_Backspace ) ) ) {
       Undo();
@@ -807,6 +994,8 @@ void TextEditor::HandleKeyboardInputs() {
       Cut();
     } else if( ctrl && !shift && !alt && ImGui::IsKeyPressed( ImGui::GetKeyIndex( ImGuiKey_A ) ) ) {
       SelectAll();
+    } else if( ctrl && !alt && ImGui::IsKeyPressed( ImGui::GetKeyIndex( ImGuiKey_Enter ) ) ) {
+      MoveToMatchingBlock( shift );
     } else if( !IsReadOnly() && !ctrl && !shift && !alt && ImGui::IsKeyPressed( ImGui::GetKeyIndex( ImGuiKey_Enter ) ) ) {
       EnterCharacter( '\n', false );
     } else if( !IsReadOnly() && !ctrl && !alt && ImGui::IsKeyPressed( ImGui::GetKeyIndex( ImGuiKey_Tab ) ) ) {
@@ -819,11 +1008,17 @@ void TextEditor::HandleKeyboardInputs() {
 
         if( c != 0 && ( c == '\n' || c >= 32 ) ) {
           EnterCharacter( c, shift );
+          typed = c < 128 && IsIdentifierChar( ( char )c );
         }
       }
 
       io.InputQueueCharacters.resize( 0 );
     }
+
+    // Typing a word opens the completions, moving or editing keeps them in sync
+    if( typed || ( mCompletionOpen && GetCursorPosition() != cursor ) ) {
+      UpdateCompletion();
+    }
   }
 }
 
@@ -833,6 +1028,26 @@ void TextEditor::HandleMouseInputs() {
   auto ctrl = io.ConfigMacOSXBehaviors ? io.KeySuper : io.KeyCtrl;
   auto alt = io.ConfigMacOSXBehaviors ? io.KeyCtrl : io.KeyAlt;
 
+  if( ImGui::IsWindowHovered() && ImGui::IsMouseClicked( 0 ) ) {
+    mCompletionOpen = false;
+  }
+
+  if( ImGui::IsWindowHovered() && ImGui::IsMouseClicked( 0 ) && IsMouseOverMinimap() ) {
+    mMinimapDragging = true;
+  }
+
+  // Clicking or dragging on the minimap scrolls the clicked line to the middle of the view
+  if( mMinimapDragging ) {
+    if( ImGui::IsMouseDown( 0 ) && mMinimapScale > 0.0f ) {
+      auto line = ( ImGui::GetMousePos().y - mMinimapMin.y ) / mMinimapScale;
+      auto row = mWordWrap ? GetLineRow( std::min( ( int )line, ( int )mLines.size() - 1 ) ) : line;
+      ImGui::SetScrollY( std::max( 0.0f, row * mCharAdvance.y - ( mMinimapMax.y - mMinimapMin.y ) * 0.5f ) );
+      return;
+    }
+
+    mMinimapDragging = false;
+  }
+
   if( ImGui::IsWindowHovered() ) {
     if( !shift && !alt ) {
       auto click = ImGui::IsMouseClicked( 0 );
@@ -903,6 +1118,11 @@ void TextEditor::HandleMouseInputs() {
 void TextEditor::Render() {
   /* Compute mCharAdvance regarding to scaled font size (Ctrl + mouse wheel)*/
   const float fontSize = ImGui::GetFont()->CalcTextSizeA( ImGui::GetFontSize(), FLT_MAX, -1.0f, "#", nullptr, nullptr ).x;
+
+  if( fontSize != mCharAdvance.x ) {
+    mHoverRow = -1;
+  }
+
   mCharAdvance = ImVec2( fontSize, ImGui::GetTextLineHeightWithSpacing() * mLineSpacing );
 
   /* Update palette with the current alpha from style */
@@ -927,57 +1147,95 @@ void TextEditor::Render() {
   auto scrollX = ImGui::GetScrollX();
   auto scrollY = ImGui::GetScrollY();
 
-  auto lineNo = ( int )floor( scrollY / mCharAdvance.y );
   auto globalLineMax = ( int )mLines.size();
-  auto lineMax = std::max( 0, std::min( ( int )mLines.size() - 1, lineNo + ( int )floor( ( scrollY + contentSize.y ) / mCharAdvance.y ) ) );
 
   // Deduce mTextStart by evaluating mLines size (global lineMax) plus two spaces as text width
   char buf[16];
   snprintf( buf, 16, " %d ", globalLineMax );
   mTextStart = ImGui::GetFont()->CalcTextSizeA( ImGui::GetFontSize(), FLT_MAX, -1.0f, buf, nullptr, nullptr ).x + mLeftMargin;
 
+  UpdateWrap();
+  UpdateBlocks();
+  UpdateBlockMatch();
+
+  // Scrolling is in visual rows, which are the lines themselves unless wrapping
+  auto firstRow = ( int )floor( scrollY / mCharAdvance.y );
+  auto lineNo = GetRowLine( firstRow );
+  auto lineMax = std::max( 0, std::min( ( int )mLines.size() - 1, GetRowLine( firstRow + ( int )floor( ( scrollY + contentSize.y ) / mCharAdvance.y ) ) ) );
+
   if( !mLines.empty() ) {
     float spaceSize = ImGui::GetFont()->CalcTextSizeA( ImGui::GetFontSize(), FLT_MAX, -1.0f, " ", nullptr, nullptr ).x;
 
+    // Draw scope guides, from below the line opening a block to the line closing it
+    UpdateScopeGuides( lineNo, lineMax );
+
+    for( auto &guide : mGuides ) {
+      auto x = cursorScreenPos.x + mTextStart + TextDistance( mLines[guide.mBegin], 0, guide.mIndent ) + 1.0f;
+      auto top = cursorScreenPos.y + GetLineRow( guide.mBegin + 1 ) * mCharAdvance.y;
+      auto bottom = cursorScreenPos.y + GetLineRow( guide.mEnd ) * mCharAdvance.y;
+      drawList->AddLine( ImVec2( x, top ), ImVec2( x, bottom ), mPalette[( int )PaletteIndex::ScopeGuide] );
+    }
+
+    auto matchColor = mPalette[( int )( mMatchFound && IsBlockPair( mMatch[0], mMatch[1] ) ? PaletteIndex::MatchingBracket : PaletteIndex::ErrorMarker )];
+
     while( lineNo <= lineMax ) {
-      ImVec2 lineStartScreenPos = ImVec2( cursorScreenPos.x, cursorScreenPos.y + lineNo * mCharAdvance.y );
+      ImVec2 lineStartScreenPos = ImVec2( cursorScreenPos.x, cursorScreenPos.y + GetLineRow( lineNo ) * mCharAdvance.y );
       ImVec2 textScreenPos = ImVec2( lineStartScreenPos.x + mTextStart, lineStartScreenPos.y );
 
       auto &line = mLines[lineNo];
-      longest = std::max( mTextStart + TextDistanceToLineStart( Coordinates( lineNo, GetLineMaxColumn( lineNo ) ) ), longest );
-      auto columnNo = 0;
-      Coordinates lineStartCoord( lineNo, 0 );
-      Coordinates lineEndCoord( lineNo, GetLineMaxColumn( lineNo ) );
+      auto rows = GetLineRowCount( line );
+      auto lineHeight = rows * mCharAdvance.y;
 
-      // Draw selection for the current line
-      float sstart = -1.0f;
-      float ssend = -1.0f;
+      if( !mWordWrap ) {
+        longest = std::max( mTextStart + TextDistanceToLineStart( Coordinates( lineNo, GetLineMaxColumn( lineNo ) ) ), longest );
+      }
+
+      auto columnNo = 0;
 
       assert( mState.mSelectionStart <= mState.mSelectionEnd );
 
-      if( mState.mSelectionStart <= lineEndCoord ) {
-        sstart = mState.mSelectionStart > lineStartCoord ? TextDistanceToLineStart( mState.mSelectionStart ) : 0.0f;
-      }
+      // Draw selection for the current line, one rectangle per row
+      for( int row = 0; row < rows; ++row ) {
+        auto rowBegin = GetRowBegin( line, row );
+        auto rowEnd = GetRowEnd( line, row );
+        Coordinates rowStartCoord( lineNo, GetCharacterColumn( lineNo, rowBegin ) );
+        Coordinates rowEndCoord( lineNo, GetCharacterColumn( lineNo, rowEnd ) );
+        float sstart = -1.0f;
+        float ssend = -1.0f;
+
+        if( mState.mSelectionStart <= rowEndCoord ) {
+          sstart = mState.mSelectionStart > rowStartCoord ? TextDistance( line, rowBegin, GetCharacterIndex( mState.mSelectionStart ) ) : 0.0f;
+        }
 
-      if( mState.mSelectionEnd > lineStartCoord ) {
-        ssend = TextDistanceToLineStart( mState.mSelectionEnd < lineEndCoord ? mState.mSelectionEnd : lineEndCoord );
-      }
+        if( mState.mSelectionEnd > rowStartCoord ) {
+          ssend = TextDistance( line, rowBegin, mState.mSelectionEnd < rowEndCoord ? GetCharacterIndex( mState.mSelectionEnd ) : rowEnd );
+        }
+
+        if( row == rows - 1 && mState.mSelectionEnd.mLine > lineNo ) {
+          ssend += mCharAdvance.x;
+        }
 
-      if( mState.mSelectionEnd.mLine > lineNo ) {
-        ssend += mCharAdvance.x;
+        if( sstart != -1 && ssend != -1 && sstart < ssend ) {
+          ImVec2 vstart( lineStartScreenPos.x + mTextStart + sstart, lineStartScreenPos.y + row * mCharAdvance.y );
+          ImVec2 vend( lineStartScreenPos.x + mTextStart + ssend, vstart.y + mCharAdvance.y );
+          drawList->AddRectFilled( vstart, vend, mPalette[( int )PaletteIndex::Selection] );
+        }
       }
 
-      if( sstart != -1 && ssend != -1 && sstart < ssend ) {
-        ImVec2 vstart( lineStartScreenPos.x + mTextStart + sstart, lineStartScreenPos.y );
-        ImVec2 vend( lineStartScreenPos.x + mTextStart + ssend, lineStartScreenPos.y + mCharAdvance.y );
-        drawList->AddRectFilled( vstart, vend, mPalette[( int )PaletteIndex::Selection] );
+      // Highlight the bracket pair at the cursor
+      if( mMatchFound ) {
+        for( auto &token : mMatch ) {
+          if( token.mLine == lineNo ) {
+            RenderBlockToken( token, lineStartScreenPos, matchColor );
+          }
+        }
       }
 
       // Draw breakpoints
       auto start = ImVec2( lineStartScreenPos.x + scrollX, lineStartScreenPos.y );
 
       if( mBreakpoints.count( lineNo + 1 ) != 0 ) {
-        auto end = ImVec2( lineStartScreenPos.x + contentSize.x + 2.0f * scrollX, lineStartScreenPos.y + mCharAdvance.y );
+        auto end = ImVec2( lineStartScreenPos.x + contentSize.x + 2.0f * scrollX, lineStartScreenPos.y + lineHeight );
         drawList->AddRectFilled( start, end, mPalette[( int )PaletteIndex::Breakpoint] );
       }
 
@@ -985,7 +1243,7 @@ void TextEditor::Render() {
       auto errorIt = mErrorMarkers.find( lineNo + 1 );
 
       if( errorIt != mErrorMarkers.end() ) {
-        auto end = ImVec2( lineStartScreenPos.x + contentSize.x + 2.0f * scrollX, lineStartScreenPos.y + mCharAdvance.y );
+        auto end = ImVec2( lineStartScreenPos.x + contentSize.x + 2.0f * scrollX, lineStartScreenPos.y + lineHeight );
         drawList->AddRectFilled( start, end, mPalette[( int )PaletteIndex::ErrorMarker] );
 
         if( ImGui::IsMouseHoveringRect( lineStartScreenPos, end ) ) {
@@ -1012,7 +1270,7 @@ void TextEditor::Render() {
 
         // Highlight the current line (where the cursor is)
         if( !HasSelection() ) {
-          auto end = ImVec2( start.x + contentSize.x + scrollX, start.y + mCharAdvance.y );
+          auto end = ImVec2( start.x + contentSize.x + scrollX, start.y + lineHeight );
           drawList->AddRectFilled( start, end, mPalette[( int )( focused ? PaletteIndex::CurrentLineFill : PaletteIndex::CurrentLineFillInactive )] );
           drawList->AddRect( start, end, mPalette[( int )PaletteIndex::CurrentLineEdge], 1.0f );
         }
@@ -1041,8 +1299,8 @@ void TextEditor::Render() {
               }
             }
 
-            ImVec2 cstart( textScreenPos.x + cx, lineStartScreenPos.y );
-            ImVec2 cend( textScreenPos.x + cx + width, lineStartScreenPos.y + mCharAdvance.y );
+            ImVec2 cstart( textScreenPos.x + cx, lineStartScreenPos.y + GetWrapRow( line, cindex ) * mCharAdvance.y );
+            ImVec2 cend( textScreenPos.x + cx + width, cstart.y + mCharAdvance.y );
             drawList->AddRectFilled( cstart, cend, mPalette[( int )PaletteIndex::Cursor] );
 
             if( elapsed > 800 ) {
@@ -1055,12 +1313,15 @@ void TextEditor::Render() {
       // Render colorized text
       auto prevColor = line.empty() ? mPalette[( int )PaletteIndex::Default] : GetGlyphColor( line[0] );
       ImVec2 bufferOffset;
+      auto row = 0;
+      auto nextBreak = GetRowEnd( line, row );
 
       for( int i = 0; i < line.size(); ) {
         auto &glyph = line[i];
         auto color = GetGlyphColor( glyph );
+        auto wrap = i >= nextBreak;
 
-        if( ( color != prevColor || glyph.mChar == '\t' || glyph.mChar == ' ' ) && !mLineBuffer.empty() ) {
+        if( ( wrap || color != prevColor || glyph.mChar == '\t' || glyph.mChar == ' ' ) && !mLineBuffer.empty() ) {
           const ImVec2 newOffset( textScreenPos.x + bufferOffset.x, textScreenPos.y + bufferOffset.y );
           drawList->AddText( newOffset, prevColor, mLineBuffer.c_str() );
           auto textSize = ImGui::GetFont()->CalcTextSizeA( ImGui::GetFontSize(), FLT_MAX, -1.0f, mLineBuffer.c_str(), nullptr, nullptr );
@@ -1068,6 +1329,11 @@ void TextEditor::Render() {
           mLineBuffer.clear();
         }
 
+        if( wrap ) {
+          bufferOffset = ImVec2( 0.0f, bufferOffset.y + mCharAdvance.y );
+          nextBreak = GetRowEnd( line, ++row );
+        }
+
         prevColor = color;
 
         if( glyph.mChar == '\t' ) {
@@ -1118,32 +1384,28 @@ void TextEditor::Render() {
       ++lineNo;
     }
 
-    // Draw a tooltip on known identifiers/preprocessor symbols
-    if( ImGui::IsMousePosValid() ) {
-      auto id = GetWordAt( ScreenPosToCoordinates( ImGui::GetMousePos() ) );
+    if( mShowMinimap ) {
+      RenderMinimap();
+    }
 
-      if( !id.empty() ) {
-        auto it = mLanguageDefinition.mIdentifiers.find( id );
+    if( mCompletionOpen ) {
+      RenderCompletion( cursorScreenPos );
+    }
 
-        if( it != mLanguageDefinition.mIdentifiers.end() ) {
-          ImGui::BeginTooltip();
-          ImGui::TextUnformatted( it->second.mDeclaration.c_str() );
-          ImGui::EndTooltip();
-        } else {
-          auto pi = mLanguageDefinition.mPreprocIdentifiers.find( id );
+    // Draw a tooltip on known identifiers/preprocessor symbols
+    else if( ImGui::IsMousePosValid() && !IsMouseOverMinimap() ) {
+      auto declaration = FindDeclarationAt( ImGui::GetMousePos() );
 
-          if( pi != mLanguageDefinition.mPreprocIdentifiers.end() ) {
-            ImGui::BeginTooltip();
-            ImGui::TextUnformatted( pi->second.mDeclaration.c_str() );
-            ImGui::EndTooltip();
-          }
-        }
+      if( declaration != nullptr ) {
+        ImGui::BeginTooltip();
+        ImGui::TextUnformatted( declaration->c_str() );
+        ImGui::EndTooltip();
       }
     }
   }
 
 
-  ImGui::Dummy( ImVec2( ( longest + 2 ), mLines.size() * mCharAdvance.y ) );
+  ImGui::Dummy( ImVec2( ( longest + 2 + ( mShowMinimap ? mMinimapWidth : 0.0f ) ), GetLineRow( ( int )mLines.size() ) * mCharAdvance.y ) );
 
   if( mScrollToCursor ) {
     EnsureCursorVisible();
@@ -1152,6 +1414,143 @@ void TextEditor::Render() {
   }
 }
 
+static unsigned HashBytes( unsigned aHash, const void *aData, size_t aSize ) {
+  auto bytes = ( const unsigned char * )aData;
+
+  for( size_t i = 0; i < aSize; ++i ) {
+    aHash = ( aHash ^ bytes[i] ) * 16777619u;
+  }
+
+  return aHash;
+}
+
+// Everything Render() draws from besides the window, which ImGui hashes itself.
+// Line versions change with the text and with its colors.
+unsigned TextEditor::GetRenderHash() const {
+  auto timeEnd = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::system_clock::now().time_since_epoch() ).count();
+  auto elapsed = timeEnd - mStartTime;
+  int state[] = {
+    ( int )mTextVersion, ( int )mLines.size(), ( int )mBlockVersion,
+    mOverwrite, mShowWhitespaces, mShowMinimap, mWordWrap, mCompletionOpen, mTabSize,
+    ( elapsed > 400 ) + ( elapsed > 800 ) // cursor blink, the timer restarts once it shows
+  };
+
+  unsigned hash = HashBytes( 2166136261u, state, sizeof( state ) );
+  hash = HashBytes( hash, &mState, sizeof( mState ) );
+  hash = HashBytes( hash, &mLineSpacing, sizeof( mLineSpacing ) );
+  hash = HashBytes( hash, mPaletteBase.data(), sizeof( mPaletteBase ) );
+
+  for( auto &marker : mErrorMarkers ) {
+    hash = HashBytes( hash, &marker.first, sizeof( marker.first ) );
+    hash = HashBytes( hash, marker.second.data(), marker.second.size() );
+  }
+
+  for( auto line : mBreakpoints ) {
+    hash ^= HashBytes( 2166136261u, &line, sizeof( line ) ); // unordered
+  }
+
+  return hash;
+}
+
+// The minimap covers the right edge of the visible area and shows the whole
+// document, one row of colored blocks per line. When there are more lines than
+// pixels, rows are sampled so the cost only depends on the minimap height.
+void TextEditor::RenderMinimap() {
+  auto drawList = ImGui::GetWindowDrawList();
+  auto windowPos = ImGui::GetWindowPos();
+  auto regionMin = ImGui::GetWindowContentRegionMin();
+  auto regionMax = ImGui::GetWindowContentRegionMax();
+  auto scrollX = ImGui::GetScrollX();
+  auto scrollY = ImGui::GetScrollY();
+
+  // The content region moves with the scrolling, the minimap doesn't
+  mMinimapMax = ImVec2( windowPos.x + regionMax.x + scrollX, windowPos.y + regionMax.y + scrollY );
+  mMinimapMin = ImVec2( mMinimapMax.x - mMinimapWidth, windowPos.y + regionMin.y + scrollY );
+
+  const float height = mMinimapMax.y - mMinimapMin.y;
+  const int lineCount = ( int )mLines.size();
+
+  if( height <= 0.0f || lineCount == 0 ) {
+    return;
+  }
+
+  mMinimapScale = std::min( 2.0f, height / lineCount );
+
+  drawList->AddRectFilled( mMinimapMin, mMinimapMax, mPalette[( int )PaletteIndex::Background] );
+
+  const bool sampled = mMinimapScale < 1.0f;
+  const int rows = sampled ? ( int )( lineCount * mMinimapScale ) : lineCount;
+  const float rowHeight = sampled ? 1.0f : mMinimapScale;
+
+  for( int row = 0; row < rows; ++row ) {
+    auto lineNo = sampled ? std::min( lineCount - 1, ( int )( row / mMinimapScale ) ) : row;
+    auto &line = mLines[lineNo];
+
+    if( line.mMinimapVersion != line.mVersion ) {
+      BuildMinimapLine( line );
+    }
+
+    const float y = mMinimapMin.y + row * rowHeight;
+
+    for( auto &run : line.mMinimap ) {
+      ImVec2 start( mMinimapMin.x + run.mColumn, y );
+      ImVec2 end( start.x + run.mLength, y + rowHeight );
+      drawList->AddRectFilled( start, end, mPalette[( int )run.mColorIndex] );
+    }
+  }
+
+  // Highlight the lines currently visible in the editor
+  float firstLine = scrollY / mCharAdvance.y;
+  float lastLine = ( scrollY + height ) / mCharAdvance.y;
+
+  if( mWordWrap ) {
+    firstLine = ( float )GetRowLine( ( int )firstLine );
+    lastLine = ( float )GetRowLine( ( int )lastLine ) + 1.0f;
+  }
+
+  const float top = mMinimapMin.y + firstLine * mMinimapScale;
+  const float bottom = mMinimapMin.y + lastLine * mMinimapScale;
+  drawList->AddRectFilled( ImVec2( mMinimapMin.x, top ), ImVec2( mMinimapMax.x, bottom ), mPalette[( int )PaletteIndex::Selection] );
+}
+
+void TextEditor::BuildMinimapLine( Line &aLine ) {
+  aLine.mMinimap.clear();
+
+  const int maxColumn = ( int )mMinimapWidth;
+  int column = 0;
+
+  for( size_t i = 0; i < aLine.size() && column < maxColumn; ) {
+    auto &glyph = aLine[i];
+    auto c = glyph.mChar;
+
+    if( c == '\t' ) {
+      column = ( column / mTabSize ) * mTabSize + mTabSize;
+    } else {
+      if( c != ' ' ) {
+        auto colorIndex = glyph.mComment ? PaletteIndex::Comment : glyph.mMultiLineComment ? PaletteIndex::MultiLineComment : glyph.mColorIndex;
+
+        if( !aLine.mMinimap.empty() && aLine.mMinimap.back().mColorIndex == colorIndex &&
+            aLine.mMinimap.back().mColumn + aLine.mMinimap.back().mLength == column ) {
+          ++aLine.mMinimap.back().mLength;
+        } else {
+          aLine.mMinimap.push_back( { ( uint16_t )column, 1, colorIndex } );
+        }
+      }
+
+      ++column;
+    }
+
+    i += UTF8CharLength( c );
+  }
+
+  aLine.mMinimapVersion = aLine.mVersion;
+}
+
+bool TextEditor::IsMouseOverMinimap() const {
+  auto mouse = ImGui::GetMousePos();
+  return mShowMinimap && mouse.x >= mMinimapMin.x && mouse.x < mMinimapMax.x && mouse.y >= mMinimapMin.y && mouse.y < mMinimapMax.y;
+}
+
 void TextEditor::Render( const char *aTitle, const ImVec2 &aSize, bool aBorder ) {
   mWithinRender = true;
   mTextChanged = false;
@@ -1174,7 +1573,10 @@ void TextEditor::Render( const char *aTitle, const ImVec2 &aSize, bool aBorder )
   }
 
   ColorizeInternal();
-  Render();
+
+  if( !mRetained || mIgnoreImGuiChild || mScrollToTop || mScrollToCursor || !ImGui::RetainWindowContents( GetRenderHash() ) ) {
+    Render();
+  }
 
   if( mHandleKeyboardInputs ) {
     ImGui::PopAllowKeyboardFocus();
@@ -1210,6 +1612,7 @@ void TextEditor::SetText( const std::string &aText ) {
   mUndoBuffer.clear();
   mUndoIndex = 0;
 
+  ResetSymbols();
   Colorize();
 }
 
@@ -1238,6 +1641,7 @@ void TextEditor::SetTextLines( const std::vector<std::string> &aLines ) {
   mUndoBuffer.clear();
   mUndoIndex = 0;
 
+  ResetSymbols();
   Colorize();
 }
 
@@ -1325,6 +1729,7 @@ void TextEditor::EnterCharacter( ImWchar aChar, bool aShift ) {
         AddUndo( u );
 
         mTextChanged = true;
+        Colorize( start.mLine, end.mLine - start.mLine + 1 );
 
         EnsureCursorVisible();
       }
@@ -1756,6 +2161,31 @@ void TextEditor::MoveEnd( bool aSelect ) {
   }
 }
 
+void TextEditor::MoveToMatchingBlock( bool aSelect ) {
+  UpdateBlocks();
+
+  BlockPosition from, to;
+
+  if( !FindBlockAt( mState.mCursorPosition, from ) || !FindMatchingBlock( from, to ) ) {
+    return;
+  }
+
+  auto oldPos = mState.mCursorPosition;
+  auto &token = mLines[to.mLine].mBlocks[to.mToken];
+  SetCursorPosition( Coordinates( to.mLine, GetCharacterColumn( to.mLine, token.mIndex ) ) );
+
+  if( mState.mCursorPosition != oldPos ) {
+    if( aSelect ) {
+      mInteractiveStart = std::min( oldPos, mState.mCursorPosition );
+      mInteractiveEnd = std::max( oldPos, mState.mCursorPosition );
+    } else {
+      mInteractiveStart = mInteractiveEnd = mState.mCursorPosition;
+    }
+
+    SetSelection( mInteractiveStart, mInteractiveEnd );
+  }
+}
+
 void TextEditor::Delete() {
   assert( !mReadOnly );
 
@@ -2010,6 +2440,8 @@ const TextEditor::Palette &TextEditor::GetDarkPalette() {
       0x40000000, // Current line fill
       0x40808080, // Current line fill (inactive)
       0x40a0a0a0, // Current line edge
+      0x60a0a0a0, // Matching bracket
+      0x30ffffff, // Scope guide
     }
   };
   return p;
@@ -2038,6 +2470,8 @@ const TextEditor::Palette &TextEditor::GetLightPalette() {
       0x40000000, // Current line fill
       0x40808080, // Current line fill (inactive)
       0x40000000, // Current line edge
+      0x40c08000, // Matching bracket
+      0x28000000, // Scope guide
     }
   };
   return p;
@@ -2066,6 +2500,8 @@ const TextEditor::Palette &TextEditor::GetRetroBluePalette() {
       0x40000000, // Current line fill
       0x40808080, // Current line fill (inactive)
       0x40000000, // Current line edge
+      0x80808000, // Matching bracket
+      0x40ffffff, // Scope guide
     }
   };
   return p;
@@ -2112,6 +2548,16 @@ void TextEditor::ProcessInputs() {
 
 void TextEditor::Colorize( int aFromLine, int aLines ) {
   int toLine = aLines == -1 ? ( int )mLines.size() : std::min( ( int )mLines.size(), aFromLine + aLines );
+
+  // The indexes read token colors, ColorizeRange() updates them once the lines are colored
+  for( int i = std::max( 0, aFromLine ); i < toLine; ++i ) {
+    if( mColorizerEnabled ) {
+      TouchLine( mLines[i] );
+    } else {
+      RefreshLine( mLines[i] );
+    }
+  }
+
   mColorRangeMin = std::min( mColorRangeMin, aFromLine );
   mColorRangeMax = std::max( mColorRangeMax, toLine );
   mColorRangeMin = std::max( 0, mColorRangeMin );
@@ -2134,6 +2580,7 @@ void TextEditor::ColorizeRange( int aFromLine, int aToLine ) {
     auto &line = mLines[i];
 
     if( line.empty() ) {
+      RefreshLine( line );
       continue;
     }
 
@@ -2215,6 +2662,8 @@ void TextEditor::ColorizeRange( int aFromLine, int aToLine ) {
         first = token_end;
       }
     }
+
+    RefreshLine( line );
   }
 }
 
@@ -2326,6 +2775,7 @@ void TextEditor::ColorizeInternal() {
         currentIndex += UTF8CharLength( c );
 
         if( currentIndex >= ( int )line.size() ) {
+          UpdateLineFlagsVersion( line );
           currentIndex = 0;
           ++currentLine;
         }
@@ -2353,23 +2803,476 @@ void TextEditor::ColorizeInternal() {
   }
 }
 
+// The comment pass rewrites the flags of every glyph, refresh the version only
+// of lines where they actually changed so per-line caches survive the pass.
+void TextEditor::UpdateLineFlagsVersion( Line &aLine ) {
+  unsigned hash = 2166136261u;
+
+  for( auto &glyph : aLine ) {
+    hash = ( hash ^ ( glyph.mComment | glyph.mMultiLineComment << 1 | glyph.mPreprocessor << 2 ) ) * 16777619u;
+  }
+
+  if( hash != aLine.mFlagsHash ) {
+    aLine.mFlagsHash = hash;
+    int index = ( int )( &aLine - mLines.data() );
+
+    // Lines still waiting for ColorizeRange() are indexed there
+    if( index >= mColorRangeMin && index < mColorRangeMax ) {
+      TouchLine( aLine );
+    } else {
+      RefreshLine( aLine );
+    }
+  }
+}
+
+void TextEditor::RefreshLine( Line &aLine ) {
+  TouchLine( aLine );
+  IndexLine( aLine );
+  IndexBlocks( aLine );
+}
+
+// Invalidates the per-line caches without indexing the line again
+void TextEditor::TouchLine( Line &aLine ) {
+  aLine.mVersion = ++mTextVersion;
+  mWrapDirtyFrom = std::min( mWrapDirtyFrom, ( int )( &aLine - mLines.data() ) );
+}
+
+// Replaces what the line contributed to the symbol index. Comments, strings,
+// numbers and keywords are left out, the kind of every other word is guessed
+// from its neighbours: "local x", "function f", "t.x" / "t:x" and "x =".
+void TextEditor::IndexLine( Line &aLine ) {
+  typedef SymbolIndex::Kind Kind;
+
+  mSymbolIndex.Release( aLine.mSymbols );
+
+  auto size = ( int )aLine.size();
+  auto pending = Kind::Identifier;
+  char previous = '\0';
+  std::string word;
+
+  for( int i = 0; i < size; ) {
+    auto &glyph = aLine[i];
+    auto c = glyph.mChar;
+
+    if( glyph.mComment || glyph.mMultiLineComment || glyph.mColorIndex == PaletteIndex::String || glyph.mColorIndex == PaletteIndex::CharLiteral ) {
+      pending = Kind::Identifier;
+      previous = '\0';
+      ++i;
+      continue;
+    }
+
+    if( isdigit( ( unsigned char )c ) ) {
+      while( i < size && ( IsIdentifierChar( aLine[i].mChar ) || aLine[i].mChar == '.' ) ) {
+        ++i;
+      }
+
+      previous = '0';
+      continue;
+    }
+
+    if( !IsIdentifierChar( c ) ) {
+      if( !isspace( ( unsigned char )c ) ) {
+        // "local a, b" declares both
+        if( c != ',' ) {
+          pending = Kind::Identifier;
+        }
+
+        previous = c;
+      }
+
+      ++i;
+      continue;
+    }
+
+    word.clear();
+
+    for( ; i < size && IsIdentifierChar( aLine[i].mChar ); ++i ) {
+      word.push_back( aLine[i].mChar );
+    }
+
+    auto before = previous;
+    previous = 'a';
+
+    if( mLanguageDefinition.mKeywords.count( word ) != 0 ) {
+      if( word == "local" ) {
+        pending = Kind::Local;
+      } else if( word == "function" ) {
+        pending = pending == Kind::Local ? Kind::Local : Kind::Global;
+      } else {
+        pending = Kind::Identifier;
+      }
+
+      continue;
+    }
+
+    auto kind = pending;
+
+    if( before == '.' || before == ':' ) {
+      kind = Kind::Member;
+    } else if( kind == Kind::Identifier ) {
+      auto next = i;
+
+      while( next < size && isspace( ( unsigned char )aLine[next].mChar ) ) {
+        ++next;
+      }
+
+      if( next < size && aLine[next].mChar == '=' && ( next + 1 >= size || aLine[next + 1].mChar != '=' ) ) {
+        kind = Kind::Global;
+      }
+    }
+
+    mSymbolIndex.Add( word.data(), word.data() + word.size(), kind, aLine.mSymbols );
+
+    if( kind != Kind::Local ) {
+      pending = Kind::Identifier;
+    }
+  }
+}
+
+// Builtins are seeded from the language definition, the lines add the rest
+// as they get colorized.
+void TextEditor::ResetSymbols() {
+  for( auto &line : mLines ) {
+    line.mSymbols.clear();
+  }
+
+  mSymbolIndex.Clear();
+  mCompletionOpen = false;
+  mHoverRow = -1;
+
+  for( auto &keyword : mLanguageDefinition.mKeywords ) {
+    mSymbolIndex.AddBuiltin( keyword, SymbolIndex::Kind::Keyword );
+  }
+
+  for( auto &identifier : mLanguageDefinition.mPreprocIdentifiers ) {
+    mSymbolIndex.AddBuiltin( identifier.first, SymbolIndex::Kind::Builtin, &identifier.second.mDeclaration );
+  }
+
+  for( auto &identifier : mLanguageDefinition.mIdentifiers ) {
+    mSymbolIndex.AddBuiltin( identifier.first, SymbolIndex::Kind::Builtin, &identifier.second.mDeclaration );
+  }
+}
+
+template<class Tokens>
+static BlockIndex::Summary SummarizeBlocks( const Tokens &aTokens ) {
+  BlockIndex::Summary summary = { 0, BlockIndex::None, BlockIndex::None };
+
+  for( auto &token : aTokens ) {
+    summary.mMinBefore = std::min( summary.mMinBefore, summary.mDelta );
+    summary.mDelta += token.mOpen ? 1 : -1;
+    summary.mMinAfter = std::min( summary.mMinAfter, summary.mDelta );
+  }
+
+  return summary;
+}
+
+// Brackets come from the punctuation and block keywords from the tokens the
+// colorizer marked as keywords, so comments and strings never count.
+void TextEditor::IndexBlocks( Line &aLine ) {
+  aLine.mBlocks.clear();
+
+  auto size = ( int )aLine.size();
+  std::string word;
+
+  for( int i = 0; i < size; ) {
+    auto &glyph = aLine[i];
+    auto c = glyph.mChar;
+
+    if( glyph.mComment || glyph.mMultiLineComment || glyph.mColorIndex == PaletteIndex::String || glyph.mColorIndex == PaletteIndex::CharLiteral ) {
+      ++i;
+      continue;
+    }
+
+    if( IsIdentifierChar( c ) ) {
+      auto begin = i;
+      word.clear();
+
+      for( ; i < size && IsIdentifierChar( aLine[i].mChar ); ++i ) {
+        word.push_back( aLine[i].mChar );
+      }
+
+      if( glyph.mColorIndex == PaletteIndex::Keyword ) {
+        if( mLanguageDefinition.mBlockBegin.count( word ) != 0 ) {
+          aLine.mBlocks.push_back( { begin, i - begin, true } );
+        } else if( mLanguageDefinition.mBlockEnd.count( word ) != 0 ) {
+          aLine.mBlocks.push_back( { begin, i - begin, false } );
+        }
+      }
+
+      continue;
+    }
+
+    if( c == '(' || c == '[' || c == '{' ) {
+      aLine.mBlocks.push_back( { i, 1, true } );
+    } else if( c == ')' || c == ']' || c == '}' ) {
+      aLine.mBlocks.push_back( { i, 1, false } );
+    }
+
+    ++i;
+  }
+
+  ++mBlockVersion;
+
+  if( !mBlocksDirty && mBlockIndex.GetSize() == ( int )mLines.size() ) {
+    mBlockIndex.Update( ( int )( &aLine - mLines.data() ), SummarizeBlocks( aLine.mBlocks ) );
+  } else {
+    mBlocksDirty = true;
+  }
+}
+
+// Lines only shift in the index when lines are inserted or removed, rebuilding
+// it then is a pass over the cached tokens of every line
+void TextEditor::UpdateBlocks() {
+  if( !mBlocksDirty && mBlockIndex.GetSize() == ( int )mLines.size() ) {
+    return;
+  }
+
+  std::vector<BlockIndex::Summary> summaries;
+  summaries.reserve( mLines.size() );
+
+  for( auto &line : mLines ) {
+    summaries.push_back( SummarizeBlocks( line.mBlocks ) );
+  }
+
+  mBlockIndex.Assign( summaries );
+  mBlocksDirty = false;
+  ++mBlockVersion;
+}
+
+// The token under aAt, or the one ending right before it
+bool TextEditor::FindBlockAt( const Coordinates &aAt, BlockPosition &aResult ) const {
+  if( aAt.mLine < 0 || aAt.mLine >= ( int )mLines.size() ) {
+    return false;
+  }
+
+  auto &tokens = mLines[aAt.mLine].mBlocks;
+  auto index = GetCharacterIndex( aAt );
+
+  for( int k = 0; k < ( int )tokens.size(); ++k ) {
+    if( index >= tokens[k].mIndex && index < tokens[k].mIndex + tokens[k].mLength ) {
+      aResult = { aAt.mLine, k };
+      return true;
+    }
+  }
+
+  for( int k = 0; k < ( int )tokens.size(); ++k ) {
+    if( index == tokens[k].mIndex + tokens[k].mLength ) {
+      aResult = { aAt.mLine, k };
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// An opening token raises the depth by one. Its match is the first token after
+// which the depth is back below that, and the other way around for a closing one.
+bool TextEditor::FindMatchingBlock( const BlockPosition &aFrom, BlockPosition &aResult ) const {
+  auto &tokens = mLines[aFrom.mLine].mBlocks;
+  auto depth = mBlockIndex.DepthBefore( aFrom.mLine );
+
+  for( int k = 0; k < aFrom.mToken; ++k ) {
+    depth += tokens[k].mOpen ? 1 : -1;
+  }
+
+  if( tokens[aFrom.mToken].mOpen ) {
+    auto target = ++depth;
+
+    for( int k = aFrom.mToken + 1; k < ( int )tokens.size(); ++k ) {
+      depth += tokens[k].mOpen ? 1 : -1;
+
+      if( depth < target ) {
+        aResult = { aFrom.mLine, k };
+        return true;
+      }
+    }
+
+    return FindClosingAfter( aFrom.mLine + 1, target, aResult );
+  }
+
+  auto target = depth;
+
+  for( int k = aFrom.mToken - 1; k >= 0; --k ) {
+    depth -= tokens[k].mOpen ? 1 : -1;
+
+    if( depth < target ) {
+      aResult = { aFrom.mLine, k };
+      return true;
+    }
+  }
+
+  return FindOpeningBefore( aFrom.mLine - 1, target, aResult );
+}
+
+// The first token from aLine on after which the depth is below aDepth
+bool TextEditor::FindClosingAfter( int aLine, int aDepth, BlockPosition &aResult ) const {
+  auto lineNo = mBlockIndex.FindClosing( aLine, aDepth );
+
+  if( lineNo < 0 ) {
+    return false;
+  }
+
+  auto &tokens = mLines[lineNo].mBlocks;
+  auto depth = mBlockIndex.DepthBefore( lineNo );
+
+  for( int k = 0; k < ( int )tokens.size(); ++k ) {
+    depth += tokens[k].mOpen ? 1 : -1;
+
+    if( depth < aDepth ) {
+      aResult = { lineNo, k };
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// The last token up to aLine before which the depth is below aDepth
+bool TextEditor::FindOpeningBefore( int aLine, int aDepth, BlockPosition &aResult ) const {
+  auto lineNo = mBlockIndex.FindOpening( aLine, aDepth );
+
+  if( lineNo < 0 ) {
+    return false;
+  }
+
+  auto &tokens = mLines[lineNo].mBlocks;
+  auto depth = mBlockIndex.DepthBefore( lineNo + 1 );
+
+  for( int k = ( int )tokens.size() - 1; k >= 0; --k ) {
+    depth -= tokens[k].mOpen ? 1 : -1;
+
+    if( depth < aDepth ) {
+      aResult = { lineNo, k };
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Brackets close with their counterpart, block keywords with any block keyword
+bool TextEditor::IsBlockPair( const BlockPosition &aOpen, const BlockPosition &aClose ) const {
+  auto &open = mLines[aOpen.mLine].mBlocks[aOpen.mToken];
+  auto &close = mLines[aClose.mLine].mBlocks[aClose.mToken];
+  auto o = mLines[aOpen.mLine][open.mIndex].mChar;
+  auto c = mLines[aClose.mLine][close.mIndex].mChar;
+
+  if( open.mLength > 1 || close.mLength > 1 ) {
+    return IsIdentifierChar( o ) && IsIdentifierChar( c );
+  }
+
+  return ( o == '(' && c == ')' ) || ( o == '[' && c == ']' ) || ( o == '{' && c == '}' );
+}
+
+void TextEditor::UpdateBlockMatch() {
+  if( mState.mCursorPosition == mMatchCursor && mBlockVersion == mMatchVersion ) {
+    return;
+  }
+
+  mMatchCursor = mState.mCursorPosition;
+  mMatchVersion = mBlockVersion;
+  mMatchFound = FindBlockAt( mMatchCursor, mMatch[0] ) && FindMatchingBlock( mMatch[0], mMatch[1] );
+
+  // Keep the opening token first
+  if( mMatchFound && !mLines[mMatch[0].mLine].mBlocks[mMatch[0].mToken].mOpen ) {
+    std::swap( mMatch[0], mMatch[1] );
+  }
+}
+
+// The blocks enclosing the first visible line are found through the index, one
+// lookup per nesting level, those opening further down from the visible tokens
+void TextEditor::UpdateScopeGuides( int aFirstLine, int aLastLine ) {
+  if( aFirstLine == mGuideFirst && aLastLine == mGuideLast && mBlockVersion == mGuideVersion ) {
+    return;
+  }
+
+  mGuideFirst = aFirstLine;
+  mGuideLast = aLastLine;
+  mGuideVersion = mBlockVersion;
+  mGuides.clear();
+
+  if( aFirstLine < 0 || aFirstLine >= ( int )mLines.size() ) {
+    return;
+  }
+
+  auto addGuide = [this]( const BlockPosition & aOpen ) {
+    BlockPosition close;
+
+    if( !FindMatchingBlock( aOpen, close ) || close.mLine <= aOpen.mLine + 1 ) {
+      return;
+    }
+
+    if( !mGuides.empty() && mGuides.back().mBegin == aOpen.mLine ) {
+      mGuides.back().mEnd = std::max( mGuides.back().mEnd, close.mLine );
+      return;
+    }
+
+    auto &line = mLines[aOpen.mLine];
+    int indent = 0;
+
+    while( indent < ( int )line.size() && ( line[indent].mChar == ' ' || line[indent].mChar == '\t' ) ) {
+      ++indent;
+    }
+
+    mGuides.push_back( { aOpen.mLine, close.mLine, indent } );
+  };
+
+  static const int MaxEnclosing = 32;
+  auto depth = mBlockIndex.DepthBefore( aFirstLine );
+
+  for( int level = depth; level > 0 && level > depth - MaxEnclosing; --level ) {
+    BlockPosition open;
+
+    if( FindOpeningBefore( aFirstLine - 1, level, open ) ) {
+      addGuide( open );
+    }
+  }
+
+  for( int lineNo = aFirstLine; lineNo <= aLastLine && lineNo < ( int )mLines.size(); ++lineNo ) {
+    auto &tokens = mLines[lineNo].mBlocks;
+
+    for( int k = 0; k < ( int )tokens.size(); ++k ) {
+      if( tokens[k].mOpen ) {
+        addGuide( { lineNo, k } );
+      }
+    }
+  }
+}
+
+void TextEditor::RenderBlockToken( const BlockPosition &aToken, const ImVec2 &aLineStartScreenPos, ImU32 aColor ) {
+  auto &line = mLines[aToken.mLine];
+  auto &token = line.mBlocks[aToken.mToken];
+  auto row = GetWrapRow( line, token.mIndex );
+  auto rowBegin = GetRowBegin( line, row );
+
+  ImVec2 start( aLineStartScreenPos.x + mTextStart + TextDistance( line, rowBegin, token.mIndex ), aLineStartScreenPos.y + row * mCharAdvance.y );
+  ImVec2 end( aLineStartScreenPos.x + mTextStart + TextDistance( line, rowBegin, token.mIndex + token.mLength ), start.y + mCharAdvance.y );
+  ImGui::GetWindowDrawList()->AddRectFilled( start, end, aColor );
+}
+
+// With word wrap the distance is measured from the start of the row aFrom is on
 float TextEditor::TextDistanceToLineStart( const Coordinates &aFrom ) const {
   auto &line = mLines[aFrom.mLine];
+  int colIndex = GetCharacterIndex( aFrom );
+
+  return TextDistance( line, GetRowBegin( line, GetWrapRow( line, colIndex ) ), colIndex );
+}
+
+float TextEditor::TextDistance( const Line &aLine, int aFrom, int aTo ) const {
   float distance = 0.0f;
   float spaceSize = ImGui::GetFont()->CalcTextSizeA( ImGui::GetFontSize(), FLT_MAX, -1.0f, " ", nullptr, nullptr ).x;
-  int colIndex = GetCharacterIndex( aFrom );
 
-  for( size_t it = 0u; it < line.size() && it < colIndex; ) {
-    if( line[it].mChar == '\t' ) {
+  for( int it = aFrom; it < ( int )aLine.size() && it < aTo; ) {
+    if( aLine[it].mChar == '\t' ) {
       distance = ( 1.0f + std::floor( ( 1.0f + distance ) / ( float( mTabSize ) * spaceSize ) ) ) * ( float( mTabSize ) * spaceSize );
       ++it;
     } else {
-      auto d = UTF8CharLength( line[it].mChar );
+      auto d = UTF8CharLength( aLine[it].mChar );
       char tempCString[7];
       int i = 0;
 
-      for( ; i < 6 && d-- > 0 && it < ( int )line.size(); i++, it++ ) {
-        tempCString[i] = line[it].mChar;
+      for( ; i < 6 && d-- > 0 && it < ( int )aLine.size(); i++, it++ ) {
+        tempCString[i] = aLine[it].mChar;
       }
 
       tempCString[i] = '\0';
@@ -2380,17 +3283,160 @@ float TextEditor::TextDistanceToLineStart( const Coordinates &aFrom ) const {
   return distance;
 }
 
+// Row counts are kept as a prefix sum over the lines, only the part after the
+// first line that changed is summed again and only changed lines are measured.
+void TextEditor::UpdateWrap() {
+  if( !mWordWrap ) {
+    return;
+  }
+
+  auto fontSize = ImGui::GetFontSize();
+  auto width = ImGui::GetWindowContentRegionWidth() - mTextStart - mCharAdvance.x - ( mShowMinimap ? mMinimapWidth : 0.0f );
+  width = std::max( width, mCharAdvance.x * 8.0f );
+
+  if( width != mWrapWidth || fontSize != mWrapFontSize ) {
+    mWrapWidth = width;
+    mWrapFontSize = fontSize;
+    mWrapDirtyFrom = 0;
+  }
+
+  if( mWrapRows.size() != mLines.size() + 1 ) {
+    mWrapRows.resize( mLines.size() + 1 );
+    mWrapDirtyFrom = std::min( mWrapDirtyFrom, ( int )mLines.size() );
+  }
+
+  if( mWrapDirtyFrom >= ( int )mLines.size() ) {
+    return;
+  }
+
+  mWrapRows[0] = 0;
+
+  for( int i = std::max( 0, mWrapDirtyFrom ); i < ( int )mLines.size(); ++i ) {
+    WrapLine( mLines[i] );
+    mWrapRows[i + 1] = mWrapRows[i] + ( int )mLines[i].mWrapBreaks.size() + 1;
+  }
+
+  mWrapDirtyFrom = INT_MAX;
+  mHoverRow = -1;
+}
+
+// Breaks after the last space or tab that fits, or mid-word when there is none
+void TextEditor::WrapLine( Line &aLine ) {
+  if( aLine.mWrapVersion == aLine.mVersion && aLine.mWrapWidth == mWrapWidth && aLine.mWrapFontSize == mWrapFontSize ) {
+    return;
+  }
+
+  aLine.mWrapVersion = aLine.mVersion;
+  aLine.mWrapWidth = mWrapWidth;
+  aLine.mWrapFontSize = mWrapFontSize;
+  aLine.mWrapBreaks.clear();
+
+  float spaceSize = ImGui::GetFont()->CalcTextSizeA( ImGui::GetFontSize(), FLT_MAX, -1.0f, " ", nullptr, nullptr ).x;
+  float x = 0.0f;
+  int rowStart = 0;
+  int lastSpace = 0;
+
+  for( int i = 0; i < ( int )aLine.size(); ) {
+    auto c = aLine[i].mChar;
+    auto length = 1;
+    float advance;
+
+    if( c == '\t' ) {
+      advance = ( 1.0f + std::floor( ( 1.0f + x ) / ( float( mTabSize ) * spaceSize ) ) ) * ( float( mTabSize ) * spaceSize ) - x;
+    } else if( c == ' ' ) {
+      advance = spaceSize;
+    } else {
+      char buf[7];
+      length = std::min( UTF8CharLength( c ), ( int )aLine.size() - i );
+
+      for( int j = 0; j < length && j < 6; ++j ) {
+        buf[j] = aLine[i + j].mChar;
+      }
+
+      buf[std::min( length, 6 )] = '\0';
+      advance = ImGui::GetFont()->CalcTextSizeA( ImGui::GetFontSize(), FLT_MAX, -1.0f, buf, nullptr, nullptr ).x;
+    }
+
+    if( x + advance > mWrapWidth && i > rowStart ) {
+      // Start the new row and measure it again from its first glyph
+      rowStart = lastSpace > rowStart ? lastSpace : i;
+      aLine.mWrapBreaks.push_back( rowStart );
+      i = rowStart;
+      x = 0.0f;
+      continue;
+    }
+
+    x += advance;
+    i += length;
+
+    if( c == ' ' || c == '\t' ) {
+      lastSpace = i;
+    }
+  }
+}
+
+int TextEditor::GetLineRowCount( const Line &aLine ) const {
+  return mWordWrap ? ( int )aLine.mWrapBreaks.size() + 1 : 1;
+}
+
+int TextEditor::GetRowBegin( const Line &aLine, int aRow ) const {
+  if( !mWordWrap || aRow <= 0 || aLine.mWrapBreaks.empty() ) {
+    return 0;
+  }
+
+  return aLine.mWrapBreaks[std::min( aRow, ( int )aLine.mWrapBreaks.size() ) - 1];
+}
+
+int TextEditor::GetRowEnd( const Line &aLine, int aRow ) const {
+  if( !mWordWrap || aRow < 0 || aRow >= ( int )aLine.mWrapBreaks.size() ) {
+    return ( int )aLine.size();
+  }
+
+  return aLine.mWrapBreaks[aRow];
+}
+
+int TextEditor::GetWrapRow( const Line &aLine, int aIndex ) const {
+  if( !mWordWrap ) {
+    return 0;
+  }
+
+  return ( int )( std::upper_bound( aLine.mWrapBreaks.begin(), aLine.mWrapBreaks.end(), aIndex ) - aLine.mWrapBreaks.begin() );
+}
+
+int TextEditor::GetLineRow( int aLine ) const {
+  if( !mWordWrap || mWrapRows.empty() ) {
+    return aLine;
+  }
+
+  return mWrapRows[std::max( 0, std::min( aLine, ( int )mWrapRows.size() - 1 ) )];
+}
+
+int TextEditor::GetRowLine( int aRow ) const {
+  if( !mWordWrap || mWrapRows.size() < 2 ) {
+    return aRow;
+  }
+
+  auto it = std::upper_bound( mWrapRows.begin(), mWrapRows.end() - 1, aRow );
+  return std::max( 0, ( int )( it - mWrapRows.begin() ) - 1 );
+}
+
+int TextEditor::GetCoordinatesRow( const Coordinates &aCoordinates ) const {
+  return GetLineRow( aCoordinates.mLine ) + GetWrapRow( mLines[aCoordinates.mLine], GetCharacterIndex( aCoordinates ) );
+}
+
 void TextEditor::EnsureCursorVisible() {
   if( !mWithinRender ) {
     mScrollToCursor = true;
     return;
   }
 
+  UpdateWrap();
+
   float scrollX = ImGui::GetScrollX();
   float scrollY = ImGui::GetScrollY();
 
   auto height = ImGui::GetWindowHeight();
-  auto width = ImGui::GetWindowWidth();
+  auto width = ImGui::GetWindowWidth() - ( mShowMinimap ? mMinimapWidth : 0.0f );
 
   auto top = 1 + ( int )ceil( scrollY / mCharAdvance.y );
   auto bottom = ( int )ceil( ( scrollY + height ) / mCharAdvance.y );
@@ -2399,14 +3445,15 @@ void TextEditor::EnsureCursorVisible() {
   auto right = ( int )ceil( ( scrollX + width ) / mCharAdvance.x );
 
   auto pos = GetActualCursorCoordinates();
+  auto row = GetCoordinatesRow( pos );
   auto len = TextDistanceToLineStart( pos );
 
-  if( pos.mLine < top ) {
-    ImGui::SetScrollY( std::max( 0.0f, ( pos.mLine - 1 ) * mCharAdvance.y ) );
+  if( row < top ) {
+    ImGui::SetScrollY( std::max( 0.0f, ( row - 1 ) * mCharAdvance.y ) );
   }
 
-  if( pos.mLine > bottom - 4 ) {
-    ImGui::SetScrollY( std::max( 0.0f, ( pos.mLine + 4 ) * mCharAdvance.y - height ) );
+  if( row > bottom - 4 ) {
+    ImGui::SetScrollY( std::max( 0.0f, ( row + 4 ) * mCharAdvance.y - height ) );
   }
 
   if( len + mTextStart < left + 4 ) {
@@ -2483,9 +3530,9 @@ const TextEditor::LanguageDefinition &TextEditor::LanguageDefinition::Lua() {
 
   if( !inited ) {
     static const char *const keywords[] = {
-      "and", "break", "do", "else", " elseif", "end",
-      "false", "for", "function", "goto", " if", "in",
-      "local", "nil", "not", "or", " repeat", "return",
+      "and", "break", "do", "else", "elseif", "end",
+      "false", "for", "function", "goto", "if", "in",
+      "local", "nil", "not", "or", "repeat", "return",
       "then", "true", "until", "while"
     };
 
@@ -2586,6 +3633,9 @@ const TextEditor::LanguageDefinition &TextEditor::LanguageDefinition::Lua() {
     langDef.mTokenRegexStrings.push_back( std::make_pair<std::string, PaletteIndex>( "[a-zA-Z_][a-zA-Z0-9_]*", PaletteIndex::Identifier ) );
     langDef.mTokenRegexStrings.push_back( std::make_pair<std::string, PaletteIndex>( "[\\[\\]\\{\\}\\!\\%\\^\\&\\*\\(\\)\\-\\+\\=\\~\\|\\<\\>\\?\\/\\:\\;\\,\\.]", PaletteIndex::Punctuation ) );
 
+    langDef.mBlockBegin = { "function", "if", "do", "repeat" };
+    langDef.mBlockEnd = { "end", "until" };
+
     langDef.mCommentStart = "--[[";
     langDef.mCommentEnd = "]]";
     langDef.mSingleLineComment = "--";
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../imgui/imgui.h"
+#include "BlockIndex.h"
+#include "SymbolIndex.h"
 #include <array>
 #include <map>
 #include <memory>
@@ -34,6 +36,8 @@ class TextEditor {
     CurrentLineFill,
     CurrentLineFillInactive,
     CurrentLineEdge,
+    MatchingBracket,
+    ScopeGuide,
     Max
   };
 
@@ -136,7 +140,43 @@ class TextEditor {
         mMultiLineComment( false ), mPreprocessor( false ) {}
   };
 
-  typedef std::vector<Glyph> Line;
+  // A horizontal block of same-colored glyphs as drawn by the minimap.
+  struct MinimapRun {
+    uint16_t mColumn;
+    uint16_t mLength;
+    PaletteIndex mColorIndex;
+  };
+
+  // A bracket or block keyword, as found in the colorized glyphs
+  struct BlockToken {
+    int mIndex;
+    int mLength;
+    bool mOpen;
+  };
+
+  // A row of glyphs plus caches derived from it. mVersion is refreshed
+  // whenever the glyphs or their colors change, so caches can tell when they
+  // were built from an older state of the line.
+  struct Line : public std::vector<Glyph> {
+    using std::vector<Glyph>::vector;
+
+    unsigned mVersion = 0;
+    unsigned mFlagsHash = 0;
+
+    unsigned mMinimapVersion = ~0u;
+    std::vector<MinimapRun> mMinimap;
+
+    SymbolIndex::References mSymbols;
+
+    // Glyph indices where the visual rows after the first one start
+    unsigned mWrapVersion = ~0u;
+    float mWrapWidth = 0.0f;
+    float mWrapFontSize = 0.0f;
+    std::vector<int> mWrapBreaks;
+
+    std::vector<BlockToken> mBlocks;
+  };
+
   typedef std::vector<Line> Lines;
 
   struct LanguageDefinition {
@@ -149,6 +189,7 @@ class TextEditor {
 
     std::string mName;
     Keywords mKeywords;
+    Keywords mBlockBegin, mBlockEnd;
     Identifiers mIdentifiers;
     Identifiers mPreprocIdentifiers;
     std::string mCommentStart, mCommentEnd, mSingleLineComment;
@@ -261,6 +302,30 @@ class TextEditor {
     return mShowWhitespaces;
   }
 
+  inline void SetShowMinimap( bool aValue ) {
+    mShowMinimap = aValue;
+  }
+  inline bool IsShowingMinimap() const {
+    return mShowMinimap;
+  }
+
+  // Keeps the text area drawn on the previous frame while nothing it is drawn
+  // from changed, see ImGui::RetainWindowContents(). Needs the ImGui child.
+  inline void SetRetained( bool aValue ) {
+    mRetained = aValue;
+  }
+  inline bool IsRetained() const {
+    return mRetained;
+  }
+
+  inline void SetWordWrap( bool aValue ) {
+    mWordWrap = aValue;
+    mWrapDirtyFrom = 0;
+  }
+  inline bool IsWordWrapping() const {
+    return mWordWrap;
+  }
+
   void SetTabSize( int aValue );
   inline int GetTabSize() const {
     return mTabSize;
@@ -277,6 +342,7 @@ class TextEditor {
   void MoveBottom( bool aSelect = false );
   void MoveHome( bool aSelect = false );
   void MoveEnd( bool aSelect = false );
+  void MoveToMatchingBlock( bool aSelect = false );
 
   void SetSelectionStart( const Coordinates &aPosition );
   void SetSelectionEnd( const Coordinates &aPosition );
@@ -342,11 +408,47 @@ class TextEditor {
 
   typedef std::vector<UndoRecord> UndoBuffer;
 
+  struct BlockPosition {
+    int mLine;
+    int mToken;
+  };
+
+  // A block spanning several lines, drawn as a vertical line at its indentation
+  struct ScopeGuide {
+    int mBegin, mEnd;
+    int mIndent; // glyphs before the first non blank of the opening line
+  };
+
   void ProcessInputs();
   void Colorize( int aFromLine = 0, int aCount = -1 );
   void ColorizeRange( int aFromLine = 0, int aToLine = 0 );
   void ColorizeInternal();
+  void UpdateLineFlagsVersion( Line &aLine );
+  void RefreshLine( Line &aLine );
+  void TouchLine( Line &aLine );
+  void IndexLine( Line &aLine );
+  void ResetSymbols();
   float TextDistanceToLineStart( const Coordinates &aFrom ) const;
+  float TextDistance( const Line &aLine, int aFrom, int aTo ) const;
+  void UpdateWrap();
+  void WrapLine( Line &aLine );
+  int GetLineRowCount( const Line &aLine ) const;
+  int GetRowBegin( const Line &aLine, int aRow ) const;
+  int GetRowEnd( const Line &aLine, int aRow ) const;
+  int GetWrapRow( const Line &aLine, int aIndex ) const;
+  int GetLineRow( int aLine ) const;
+  int GetRowLine( int aRow ) const;
+  int GetCoordinatesRow( const Coordinates &aCoordinates ) const;
+  void IndexBlocks( Line &aLine );
+  void UpdateBlocks();
+  bool FindBlockAt( const Coordinates &aAt, BlockPosition &aResult ) const;
+  bool FindMatchingBlock( const BlockPosition &aFrom, BlockPosition &aResult ) const;
+  bool FindOpeningBefore( int aLine, int aDepth, BlockPosition &aResult ) const;
+  bool FindClosingAfter( int aLine, int aDepth, BlockPosition &aResult ) const;
+  bool IsBlockPair( const BlockPosition &aOpen, const BlockPosition &aClose ) const;
+  void UpdateBlockMatch();
+  void UpdateScopeGuides( int aFirstLine, int aLastLine );
+  void RenderBlockToken( const BlockPosition &aToken, const ImVec2 &aLineStartScreenPos, ImU32 aColor );
   void EnsureCursorVisible();
   int GetPageSize() const;
   std::string GetText( const Coordinates &aStart, const Coordinates &aEnd ) const;
@@ -373,11 +475,19 @@ class TextEditor {
   void DeleteSelection();
   std::string GetWordUnderCursor() const;
   std::string GetWordAt( const Coordinates &aCoords ) const;
+  const std::string *FindDeclarationAt( const ImVec2 &aPosition );
+  void UpdateCompletion();
+  void AcceptCompletion();
+  void RenderCompletion( const ImVec2 &aCursorScreenPos );
   ImU32 GetGlyphColor( const Glyph &aGlyph ) const;
 
   void HandleKeyboardInputs();
   void HandleMouseInputs();
   void Render();
+  unsigned GetRenderHash() const;
+  void RenderMinimap();
+  void BuildMinimapLine( Line &aLine );
+  bool IsMouseOverMinimap() const;
 
   float mLineSpacing;
   Lines mLines;
@@ -403,6 +513,44 @@ class TextEditor {
   bool mHandleMouseInputs;
   bool mIgnoreImGuiChild;
   bool mShowWhitespaces;
+  bool mShowMinimap;
+  bool mRetained;
+  bool mMinimapDragging;
+  float mMinimapWidth;
+  float mMinimapScale; // minimap pixels per line, from the last frame
+  ImVec2 mMinimapMin, mMinimapMax;
+  unsigned mTextVersion;
+
+  SymbolIndex mSymbolIndex;
+  bool mCompletionOpen;
+  int mCompletionIndex;
+  std::vector<SymbolIndex::Completion> mCompletions;
+
+  // Visual rows: mWrapRows[i] is the first row of line i, the last entry the row count
+  bool mWordWrap;
+  float mWrapWidth, mWrapFontSize;
+  int mWrapDirtyFrom; // first line whose row count may be out of date
+  std::vector<int> mWrapRows;
+
+  BlockIndex mBlockIndex;
+  bool mBlocksDirty; // line count changed, the index is rebuilt on the next frame
+  unsigned mBlockVersion;
+
+  // Bracket pair at the cursor, refreshed when the cursor or the blocks change
+  Coordinates mMatchCursor;
+  unsigned mMatchVersion;
+  bool mMatchFound;
+  BlockPosition mMatch[2];
+
+  int mGuideFirst, mGuideLast;
+  unsigned mGuideVersion;
+  std::vector<ScopeGuide> mGuides;
+
+  // Last hovered word, bounds are in pixels from the left of its row
+  int mHoverRow;
+  unsigned mHoverVersion;
+  float mHoverStart, mHoverEnd;
+  const std::string *mHoverDeclaration;
 
   Palette mPaletteBase;
   Palette mPalette;
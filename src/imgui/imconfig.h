@@ -72,6 +72,15 @@
 //default allocators calling malloc()/free() to avoid linking with them. You
 //will need to call ImGui::SetAllocatorFunctions().
 
+//---- Tessellate lines with scalar code only, even when SSE2, NEON or WASM
+//SIMD128 are available at compile time (e.g. emscripten with -msimd128).
+//#define IMGUI_DISABLE_SIMD
+
+//---- Keep ImGuiStorage (window state, tree node open state...) in a hash table
+//instead of a sorted array. Lookups and insertions stay O(1) with many thousands
+//of IDs, at the cost of some unused slots.
+//#define IMGUI_USE_HASHED_STORAGE
+
 //---- Include imgui_user.h at the end of imgui.h as a convenience
 //#define IMGUI_INCLUDE_IMGUI_USER_H
 
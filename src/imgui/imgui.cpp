@@ -816,6 +816,7 @@ static void             SetCurrentWindow( ImGuiWindow *window );
 static void             FindHoveredWindow();
 static ImGuiWindow     *CreateNewWindow( const char *name, ImGuiWindowFlags flags );
 static ImVec2           CalcNextScrollFromScrollTargetAndClamp( ImGuiWindow *window );
+static void             EndRetainedWindowContents( ImGuiWindow *window, bool keep );
 
 static void             AddDrawListToDrawData( ImVector<ImDrawList *> *out_list, ImDrawList *draw_list );
 static void             AddWindowToSortBuffer( ImVector<ImGuiWindow *> *out_sorted_windows, ImGuiWindow *window );
@@ -1157,7 +1158,7 @@ ImVec2 ImBezierClosestPoint( const ImVec2 &p1, const ImVec2 &p2, const ImVec2 &p
   return p_closest;
 }
 
-// Closely mimics PathBezierToCasteljau() in imgui_draw.cpp
+// Recursive de Casteljau subdivision, stops once the control points are flat enough for tess_tol
 static void BezierClosestPointCasteljauStep( const ImVec2 &p, ImVec2 &p_closest, ImVec2 &p_last, float &p_closest_dist2, float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4, float tess_tol, int level ) {
   float dx = x4 - x1;
   float dy = y4 - y1;
@@ -1470,7 +1471,7 @@ int ImFormatStringV( char *buf, size_t buf_size, const char *fmt, va_list args )
 // CRC32 needs a 1KB lookup table (not cache friendly)
 // Although the code to generate the table is simple and shorter than the table itself, using a const table allows us to easily:
 // - avoid an unnecessary branch/memory tap, - keep the ImHashXXX functions usable by static constructors, - make it thread-safe.
-static const ImU32 GCrc32LookupTable[256] = {
+static constexpr ImU32 GCrc32LookupTable[256] = {
   0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F, 0xE963A535, 0x9E6495A3, 0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988, 0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91,
   0x1DB71064, 0x6AB020F2, 0xF3B97148, 0x84BE41DE, 0x1ADAD47D, 0x6DDDE4EB, 0xF4D4B551, 0x83D385C7, 0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC, 0x14015C4F, 0x63066CD9, 0xFA0F3D63, 0x8D080DF5,
   0x3B6E20C8, 0x4C69105E, 0xD56041E4, 0xA2677172, 0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B, 0x35B5A8FA, 0x42B2986C, 0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59,
@@ -1489,14 +1490,64 @@ static const ImU32 GCrc32LookupTable[256] = {
   0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605, 0xCDD70693, 0x54DE5729, 0x23D967BF, 0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94, 0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D,
 };
 
+// Slice-by-8 tables: GCrc32SliceTables.Lut[k][b] is the CRC of byte b followed by k zero bytes, so 8 bytes can be
+// folded into the CRC with 8 independent lookups instead of a chain of 8. Built at compile time from GCrc32LookupTable,
+// so the hash functions stay usable by static constructors and give the same results as the byte-at-a-time loop.
+// (A hardware CRC32 instruction such as SSE4.2 _mm_crc32_u64 computes CRC-32C, another polynomial, and would change every ID.)
+struct ImCrc32SliceTables {
+  ImU32 Lut[8][256];
+};
+
+static constexpr ImCrc32SliceTables ImCrc32BuildSliceTables() {
+  ImCrc32SliceTables tables = {};
+
+  for( int n = 0; n < 256; n++ )
+    tables.Lut[0][n] = GCrc32LookupTable[n];
+
+  for( int k = 1; k < 8; k++ )
+    for( int n = 0; n < 256; n++ )
+      tables.Lut[k][n] = ( tables.Lut[k - 1][n] >> 8 ) ^ GCrc32LookupTable[tables.Lut[k - 1][n] & 0xFF];
+
+  return tables;
+}
+
+static constexpr ImCrc32SliceTables GCrc32SliceTables = ImCrc32BuildSliceTables();
+
+static inline ImU32 ImReadLE32( const unsigned char *data ) {
+  return ( ImU32 )data[0] | ( ( ImU32 )data[1] << 8 ) | ( ( ImU32 )data[2] << 16 ) | ( ( ImU32 )data[3] << 24 );
+}
+
+// Fold the next 8 bytes into 'crc'
+static inline ImU32 ImCrc32Slice8( ImU32 crc, const unsigned char *data ) {
+  const ImU32( *lut )[256] = GCrc32SliceTables.Lut;
+  const ImU32 lo = ImReadLE32( data ) ^ crc;
+  const ImU32 hi = ImReadLE32( data + 4 );
+  return lut[7][lo & 0xFF] ^ lut[6][( lo >> 8 ) & 0xFF] ^ lut[5][( lo >> 16 ) & 0xFF] ^ lut[4][lo >> 24] ^
+         lut[3][hi & 0xFF] ^ lut[2][( hi >> 8 ) & 0xFF] ^ lut[1][( hi >> 16 ) & 0xFF] ^ lut[0][hi >> 24];
+}
+
+// Shorter inputs, like the pointers and integers pushed as IDs, are cheaper byte by byte than with the table lookups
+static const size_t ImCrc32SliceMinSize = 16;
+
+// True when one of the 8 bytes at 'data' is a '#'
+static inline bool ImHasHash8( const unsigned char *data ) {
+  const ImU32 pattern = 0x23232323;
+  const ImU32 lo = ImReadLE32( data ) ^ pattern;
+  const ImU32 hi = ImReadLE32( data + 4 ) ^ pattern;
+  return ( ( ( lo - 0x01010101 ) & ~lo ) | ( ( hi - 0x01010101 ) & ~hi ) ) & 0x80808080;
+}
+
 // Known size hash
 // It is ok to call ImHashData on a string with known length but the ### operator won't be supported.
-// FIXME-OPT: Replace with e.g. FNV1a hash? CRC32 pretty much randomly access 1KB. Need to do proper measurements.
 ImU32 ImHashData( const void *data_p, size_t data_size, ImU32 seed ) {
   ImU32 crc = ~seed;
   const unsigned char *data = ( const unsigned char * )data_p;
   const ImU32 *crc32_lut = GCrc32LookupTable;
 
+  if( data_size >= ImCrc32SliceMinSize )
+    for( ; data_size >= 8; data_size -= 8, data += 8 )
+      crc = ImCrc32Slice8( crc, data );
+
   while( data_size-- != 0 ) {
     crc = ( crc >> 8 ) ^ crc32_lut[( crc & 0xFF ) ^ *data++];
   }
@@ -1509,16 +1560,32 @@ ImU32 ImHashData( const void *data_p, size_t data_size, ImU32 seed ) {
 // Because this syntax is rarely used we are optimizing for the common case.
 // - If we reach ### in the string we discard the hash so far and reset to the seed.
 // - We don't do 'current += 2; continue;' after handling ### to keep the code smaller/faster (measured ~10% diff in Debug build)
-// FIXME-OPT: Replace with e.g. FNV1a hash? CRC32 pretty much randomly access 1KB. Need to do proper measurements.
+// - Runs of 8 bytes without a '#' go through the slice-by-8 tables, the others byte by byte with the ### check.
+//   Strings shorter than ImCrc32SliceMinSize are hashed byte by byte only.
+//   Zero-terminated strings are measured first, strlen() is cheaper than checking for the terminator byte by byte.
 ImU32 ImHashStr( const char *data_p, size_t data_size, ImU32 seed ) {
   seed = ~seed;
   ImU32 crc = seed;
   const unsigned char *data = ( const unsigned char * )data_p;
   const ImU32 *crc32_lut = GCrc32LookupTable;
 
-  if( data_size != 0 ) {
-    while( data_size-- != 0 ) {
+  if( data_size == 0 ) {
+    data_size = strlen( data_p );
+  }
+
+  const bool slice = data_size >= ImCrc32SliceMinSize;
+
+  while( slice && data_size >= 8 ) {
+    if( !ImHasHash8( data ) ) {
+      crc = ImCrc32Slice8( crc, data );
+      data += 8;
+      data_size -= 8;
+      continue;
+    }
+
+    for( const unsigned char *data_end = data + 8; data < data_end; ) {
       unsigned char c = *data++;
+      data_size--;
 
       if( c == '#' && data_size >= 2 && data[0] == '#' && data[1] == '#' ) {
         crc = seed;
@@ -1526,14 +1593,16 @@ ImU32 ImHashStr( const char *data_p, size_t data_size, ImU32 seed ) {
 
       crc = ( crc >> 8 ) ^ crc32_lut[( crc & 0xFF ) ^ c];
     }
-  } else {
-    while( unsigned char c = *data++ ) {
-      if( c == '#' && data[0] == '#' && data[1] == '#' ) {
-        crc = seed;
-      }
+  }
 
-      crc = ( crc >> 8 ) ^ crc32_lut[( crc & 0xFF ) ^ c];
+  while( data_size-- != 0 ) {
+    unsigned char c = *data++;
+
+    if( c == '#' && data_size >= 2 && data[0] == '#' && data[1] == '#' ) {
+      crc = seed;
     }
+
+    crc = ( crc >> 8 ) ^ crc32_lut[( crc & 0xFF ) ^ c];
   }
 
   return ~crc;
@@ -2013,6 +2082,126 @@ void ImGui::ColorConvertHSVtoRGB( float h, float s, float v, float &out_r, float
 // Helper: Key->value storage
 //-----------------------------------------------------------------------------
 
+#ifdef IMGUI_USE_HASHED_STORAGE
+
+// Slot a key starts probing from. IDs are CRC32 already but keys set by hand are often small consecutive integers, so mix them.
+static inline int StorageSlot( ImGuiID key, int mask ) {
+  key *= 0x9E3779B1u;
+  return ( int )( ( key ^ ( key >> 16 ) ) & ( ImGuiID )mask );
+}
+
+static ImGuiStorage::ImGuiStoragePair *StorageFind( const ImGuiStorage *storage, ImGuiID key ) {
+  if( key == 0 ) {
+    return storage->HasZeroPair ? const_cast<ImGuiStorage::ImGuiStoragePair *>( &storage->ZeroPair ) : NULL;
+  }
+
+  if( storage->Data.Size == 0 ) {
+    return NULL;
+  }
+
+  const int mask = storage->Data.Size - 1;
+
+  for( int n = StorageSlot( key, mask );; n = ( n + 1 ) & mask ) {
+    ImGuiStorage::ImGuiStoragePair *it = const_cast<ImGuiStorage::ImGuiStoragePair *>( &storage->Data.Data[n] );
+
+    if( it->key == key ) {
+      return it;
+    }
+
+    if( it->key == 0 ) {
+      return NULL;
+    }
+  }
+}
+
+// Moves the pairs of key != 0 in 'pairs' to a table of 'capacity' slots, which must be a power of two larger than their count
+static void StorageRehash( ImGuiStorage *storage, const ImGuiStorage::ImGuiStoragePair *pairs, int pairs_count, int capacity ) {
+  ImVector<ImGuiStorage::ImGuiStoragePair> table;
+  table.resize( capacity );
+  memset( table.Data, 0, ( size_t )table.size_in_bytes() );
+  const int mask = capacity - 1;
+  int count = 0;
+
+  for( int i = 0; i < pairs_count; i++ ) {
+    if( pairs[i].key == 0 ) {
+      continue;
+    }
+
+    int n = StorageSlot( pairs[i].key, mask );
+
+    while( table.Data[n].key != 0 && table.Data[n].key != pairs[i].key ) {
+      n = ( n + 1 ) & mask;
+    }
+
+    if( table.Data[n].key == 0 ) {
+      count++;
+    }
+
+    table.Data[n] = pairs[i];
+  }
+
+  storage->Data.swap( table );
+  storage->Count = count;
+}
+
+// Returns the pair of pair.key, adding 'pair' when there's none
+static ImGuiStorage::ImGuiStoragePair *StorageFindOrAdd( ImGuiStorage *storage, const ImGuiStorage::ImGuiStoragePair &pair ) {
+  if( pair.key == 0 ) {
+    if( !storage->HasZeroPair ) {
+      storage->ZeroPair = pair;
+      storage->HasZeroPair = true;
+    }
+
+    return &storage->ZeroPair;
+  }
+
+  // Keep the table at most 3/4 full so probe sequences stay short
+  if( ( storage->Count + 1 ) * 4 > storage->Data.Size * 3 ) {
+    ImVector<ImGuiStorage::ImGuiStoragePair> old;
+    old.swap( storage->Data );
+    StorageRehash( storage, old.Data, old.Size, old.Size ? old.Size * 2 : 16 );
+  }
+
+  const int mask = storage->Data.Size - 1;
+  int n = StorageSlot( pair.key, mask );
+
+  while( storage->Data.Data[n].key != 0 ) {
+    if( storage->Data.Data[n].key == pair.key ) {
+      return &storage->Data.Data[n];
+    }
+
+    n = ( n + 1 ) & mask;
+  }
+
+  storage->Data.Data[n] = pair;
+  storage->Count++;
+  return &storage->Data.Data[n];
+}
+
+// For quicker full rebuild of a storage (instead of an incremental one), you may add all your contents and then sort once.
+// The pairs pushed into Data are not a table yet, rehash them all at once.
+void ImGuiStorage::BuildSortByKey() {
+  HasZeroPair = false;
+
+  for( int i = 0; i < Data.Size; i++ )
+    if( Data[i].key == 0 ) {
+      ZeroPair = Data[i];
+      HasZeroPair = true;
+    }
+
+  int capacity = 16;
+
+  while( capacity * 3 < Data.Size * 4 ) {
+    capacity *= 2;
+  }
+
+  ImVector<ImGuiStoragePair> pairs;
+  pairs.swap( Data );
+  StorageRehash( this, pairs.Data, pairs.Size, capacity );
+}
+
+#else
+
 // std::lower_bound but without the bullshit
 static ImGuiStorage::ImGuiStoragePair *LowerBound( ImVector<ImGuiStorage::ImGuiStoragePair> &data, ImGuiID key ) {
   ImGuiStorage::ImGuiStoragePair *first = data.Data;
@@ -2034,6 +2223,28 @@ static ImGuiStorage::ImGuiStoragePair *LowerBound( ImVector<ImGuiStorage::ImGuiS
   return first;
 }
 
+static ImGuiStorage::ImGuiStoragePair *StorageFind( const ImGuiStorage *storage, ImGuiID key ) {
+  ImVector<ImGuiStorage::ImGuiStoragePair> &data = const_cast<ImVector<ImGuiStorage::ImGuiStoragePair>&>( storage->Data );
+  ImGuiStorage::ImGuiStoragePair *it = LowerBound( data, key );
+
+  if( it == data.end() || it->key != key ) {
+    return NULL;
+  }
+
+  return it;
+}
+
+// Returns the pair of pair.key, inserting 'pair' when there's none
+static ImGuiStorage::ImGuiStoragePair *StorageFindOrAdd( ImGuiStorage *storage, const ImGuiStorage::ImGuiStoragePair &pair ) {
+  ImGuiStorage::ImGuiStoragePair *it = LowerBound( storage->Data, pair.key );
+
+  if( it == storage->Data.end() || it->key != pair.key ) {
+    it = storage->Data.insert( it, pair );
+  }
+
+  return it;
+}
+
 // For quicker full rebuild of a storage (instead of an incremental one), you may add all your contents and then sort once.
 void ImGuiStorage::BuildSortByKey() {
   struct StaticFunc {
@@ -2056,14 +2267,11 @@ void ImGuiStorage::BuildSortByKey() {
   }
 }
 
-int ImGuiStorage::GetInt( ImGuiID key, int default_val ) const {
-  ImGuiStoragePair *it = LowerBound( const_cast<ImVector<ImGuiStoragePair>&>( Data ), key );
-
-  if( it == Data.end() || it->key != key ) {
-    return default_val;
-  }
+#endif // #ifdef IMGUI_USE_HASHED_STORAGE
 
-  return it->val_i;
+int ImGuiStorage::GetInt( ImGuiID key, int default_val ) const {
+  ImGuiStoragePair *it = StorageFind( this, key );
+  return it ? it->val_i : default_val;
 }
 
 bool ImGuiStorage::GetBool( ImGuiID key, bool default_val ) const {
@@ -2071,34 +2279,18 @@ bool ImGuiStorage::GetBool( ImGuiID key, bool default_val ) const {
 }
 
 float ImGuiStorage::GetFloat( ImGuiID key, float default_val ) const {
-  ImGuiStoragePair *it = LowerBound( const_cast<ImVector<ImGuiStoragePair>&>( Data ), key );
-
-  if( it == Data.end() || it->key != key ) {
-    return default_val;
-  }
-
-  return it->val_f;
+  ImGuiStoragePair *it = StorageFind( this, key );
+  return it ? it->val_f : default_val;
 }
 
 void *ImGuiStorage::GetVoidPtr( ImGuiID key ) const {
-  ImGuiStoragePair *it = LowerBound( const_cast<ImVector<ImGuiStoragePair>&>( Data ), key );
-
-  if( it == Data.end() || it->key != key ) {
-    return NULL;
-  }
-
-  return it->val_p;
+  ImGuiStoragePair *it = StorageFind( this, key );
+  return it ? it->val_p : NULL;
 }
 
 // References are only valid until a new value is added to the storage. Calling a Set***() function or a Get***Ref() function invalidates the pointer.
 int *ImGuiStorage::GetIntRef( ImGuiID key, int default_val ) {
-  ImGuiStoragePair *it = LowerBound( Data, key );
-
-  if( it == Data.end() || it->key != key ) {
-    it = Data.insert( it, ImGuiStoragePair( key, default_val ) );
-  }
-
-  return &it->val_i;
+  return &StorageFindOrAdd( this, ImGuiStoragePair( key, default_val ) )->val_i;
 }
 
 bool *ImGuiStorage::GetBoolRef( ImGuiID key, bool default_val ) {
@@ -2106,35 +2298,16 @@ bool *ImGuiStorage::GetBoolRef( ImGuiID key, bool default_val ) {
 }
 
 float *ImGuiStorage::GetFloatRef( ImGuiID key, float default_val ) {
-  ImGuiStoragePair *it = LowerBound( Data, key );
-
-  if( it == Data.end() || it->key != key ) {
-    it = Data.insert( it, ImGuiStoragePair( key, default_val ) );
-  }
-
-  return &it->val_f;
+  return &StorageFindOrAdd( this, ImGuiStoragePair( key, default_val ) )->val_f;
 }
 
 void **ImGuiStorage::GetVoidPtrRef( ImGuiID key, void *default_val ) {
-  ImGuiStoragePair *it = LowerBound( Data, key );
-
-  if( it == Data.end() || it->key != key ) {
-    it = Data.insert( it, ImGuiStoragePair( key, default_val ) );
-  }
-
-  return &it->val_p;
+  return &StorageFindOrAdd( this, ImGuiStoragePair( key, default_val ) )->val_p;
 }
 
-// FIXME-OPT: Need a way to reuse the result of lower_bound when doing GetInt()/SetInt() - not too bad because it only happens on explicit interaction (maximum one a frame)
+// A single lookup finds the pair or where to insert it
 void ImGuiStorage::SetInt( ImGuiID key, int val ) {
-  ImGuiStoragePair *it = LowerBound( Data, key );
-
-  if( it == Data.end() || it->key != key ) {
-    Data.insert( it, ImGuiStoragePair( key, val ) );
-    return;
-  }
-
-  it->val_i = val;
+  StorageFindOrAdd( this, ImGuiStoragePair( key, val ) )->val_i = val;
 }
 
 void ImGuiStorage::SetBool( ImGuiID key, bool val ) {
@@ -2142,31 +2315,22 @@ void ImGuiStorage::SetBool( ImGuiID key, bool val ) {
 }
 
 void ImGuiStorage::SetFloat( ImGuiID key, float val ) {
-  ImGuiStoragePair *it = LowerBound( Data, key );
-
-  if( it == Data.end() || it->key != key ) {
-    Data.insert( it, ImGuiStoragePair( key, val ) );
-    return;
-  }
-
-  it->val_f = val;
+  StorageFindOrAdd( this, ImGuiStoragePair( key, val ) )->val_f = val;
 }
 
 void ImGuiStorage::SetVoidPtr( ImGuiID key, void *val ) {
-  ImGuiStoragePair *it = LowerBound( Data, key );
-
-  if( it == Data.end() || it->key != key ) {
-    Data.insert( it, ImGuiStoragePair( key, val ) );
-    return;
-  }
-
-  it->val_p = val;
+  StorageFindOrAdd( this, ImGuiStoragePair( key, val ) )->val_p = val;
 }
 
 void ImGuiStorage::SetAllInt( int v ) {
+  // Free slots of the hash table keep key 0, writing their value is harmless
   for( int i = 0; i < Data.Size; i++ ) {
     Data[i].val_i = v;
   }
+
+#ifdef IMGUI_USE_HASHED_STORAGE
+  ZeroPair.val_i = v;
+#endif
 }
 
 //-----------------------------------------------------------------------------
@@ -3252,6 +3416,7 @@ void ImGui::GcCompactTransientWindowBuffers( ImGuiWindow *window ) {
   window->MemoryDrawListVtxCapacity = window->DrawList->VtxBuffer.Capacity;
   window->IDStack.clear();
   window->DrawList->_ClearFreeMemory();
+  window->Retained.Clear();
   window->DC.ChildWindows.clear();
   window->DC.ItemFlagsStack.clear();
   window->DC.ItemWidthStack.clear();
@@ -4139,6 +4304,7 @@ void ImGui::NewFrame() {
   g.DrawListSharedData.ClipRectFullscreen = ImVec4( 0.0f, 0.0f, g.IO.DisplaySize.x, g.IO.DisplaySize.y );
   g.DrawListSharedData.CurveTessellationTol = g.Style.CurveTessellationTol;
   g.DrawListSharedData.SetCircleSegmentMaxError( g.Style.CircleSegmentMaxError );
+  g.DrawListSharedData.TextRuns.NewFrame( g.IO.Fonts->TexID );
   g.DrawListSharedData.InitialFlags = ImDrawListFlags_None;
 
   if( g.Style.AntiAliasedLines ) {
@@ -4438,6 +4604,7 @@ void ImGui::Shutdown( ImGuiContext *context ) {
   g.ClipboardHandlerData.clear();
   g.MenusIdSubmittedThisFrame.clear();
   g.InputTextState.ClearFreeMemory();
+  g.InputTextLineIndexes.Clear();
 
   g.SettingsWindows.clear();
   g.SettingsHandlers.clear();
@@ -6087,6 +6254,11 @@ bool ImGui::Begin( const char *name, bool *p_open, ImGuiWindowFlags flags ) {
   ImGuiWindow *parent_window = first_begin_of_the_frame ? ( ( flags & ( ImGuiWindowFlags_ChildWindow | ImGuiWindowFlags_Popup ) ) ? parent_window_in_stack : NULL ) : window->ParentWindow;
   IM_ASSERT( parent_window != NULL || !( flags & ImGuiWindowFlags_ChildWindow ) );
 
+  // Retained contents can't open windows of their own, those would be skipped along with them
+  if( parent_window_in_stack && parent_window_in_stack->Retained.RecordingKey != 0 ) {
+    EndRetainedWindowContents( parent_window_in_stack, false );
+  }
+
   // We allow window memory to be compacted so recreate the base stack when needed.
   if( window->IDStack.Size == 0 ) {
     window->IDStack.push_back( window->ID );
@@ -6719,6 +6891,139 @@ bool ImGui::Begin( const char *name, bool *p_open, ImGuiWindowFlags flags ) {
   return !window->SkipItems;
 }
 
+// Mouse buttons, wheel and keys are acted upon by the contents of the hovered and the focused window
+static bool IsWindowReceivingInput( ImGuiWindow *window ) {
+  ImGuiContext &g = *GImGui;
+  const ImGuiIO &io = g.IO;
+
+  if( g.HoveredWindow != window && g.NavWindow != window ) {
+    return false;
+  }
+
+  if( io.MouseWheel != 0.0f || io.MouseWheelH != 0.0f || io.InputQueueCharacters.Size > 0 ) {
+    return true;
+  }
+
+  // Down this frame or the previous one, so releases count as well
+  for( int n = 0; n < IM_ARRAYSIZE( io.MouseDown ); n++ )
+    if( io.MouseDown[n] || io.MouseDownDurationPrev[n] >= 0.0f ) {
+      return true;
+    }
+
+  for( int n = 0; n < IM_ARRAYSIZE( io.KeysDown ); n++ )
+    if( io.KeysDown[n] || io.KeysDownDurationPrev[n] >= 0.0f ) {
+      return true;
+    }
+
+  return false;
+}
+
+bool ImGui::RetainWindowContents( ImU32 contents_hash ) {
+  ImGuiContext &g = *GImGui;
+  ImGuiWindow *window = g.CurrentWindow;
+  ImGuiWindowRetained &retained = window->Retained;
+  ImDrawList *draw_list = window->DrawList;
+  IM_ASSERT( retained.RecordingKey == 0 && "Calling RetainWindowContents() twice within the same Begin()/End()!" );
+
+  // Only the first Begin() of the frame is retained, appending to the window afterwards is submitted as usual
+  if( window->BeginCount > 1 ) {
+    return false;
+  }
+
+  if( window->SkipItems || window->Appearing || ( g.ActiveId != 0 && g.ActiveIdWindow == window ) || draw_list->_Splitter._Count > 1 || IsWindowReceivingInput( window ) ) {
+    retained.Key = 0;
+    return false;
+  }
+
+  // Everything the contents are laid out and drawn from, down to the state of the draw list they get appended to
+  const bool hovered = ( g.HoveredWindow == window );
+  const bool focused = ( g.NavWindow == window );
+  ImU32 key = ImHashData( &contents_hash, sizeof( contents_hash ), window->ID );
+  key = ImHashData( &window->Pos, sizeof( ImVec2 ), key );
+  key = ImHashData( &window->Size, sizeof( ImVec2 ), key );
+  key = ImHashData( &window->Scroll, sizeof( ImVec2 ), key );
+  key = ImHashData( &window->ContentSize, sizeof( ImVec2 ), key );
+  key = ImHashData( &window->DC.CursorPos, sizeof( ImVec2 ), key );
+  key = ImHashData( &window->ClipRect, sizeof( ImRect ), key );
+  key = ImHashData( &g.Font, sizeof( g.Font ), key );
+  key = ImHashData( &g.FontSize, sizeof( g.FontSize ), key );
+  key = ImHashData( &g.Style.Alpha, sizeof( g.Style.Alpha ), key );
+  key = ImHashData( &hovered, sizeof( hovered ), key );
+  key = ImHashData( &focused, sizeof( focused ), key );
+
+  if( hovered ) {
+    key = ImHashData( &g.IO.MousePos, sizeof( ImVec2 ), key );
+  }
+
+  const int draw_list_state[] = { draw_list->Flags, ( int )draw_list->_VtxCurrentIdx, draw_list->VtxBuffer.Size, draw_list->IdxBuffer.Size, draw_list->CmdBuffer.Size, draw_list->_ClipRectStack.Size, draw_list->_TextureIdStack.Size };
+  key = ImHashData( draw_list_state, sizeof( draw_list_state ), key );
+  key = ImHashData( &draw_list->_CmdHeader, IM_OFFSETOF( ImDrawCmd, VtxOffset ) + sizeof( unsigned int ), key );
+  key = ImHashData( &draw_list->CmdBuffer.back(), IM_OFFSETOF( ImDrawCmd, ElemCount ) + sizeof( unsigned int ), key );
+
+  if( key == 0 ) {
+    key = 1;
+  }
+
+  if( key == retained.Key ) {
+    // Same contents appended to the same draw list state: put back the commands that followed, and what they left behind
+    draw_list->CmdBuffer.resize( retained.CmdBegin );
+    draw_list->CmdBuffer.reserve( retained.CmdBegin + retained.CmdBuffer.Size );
+    memcpy( draw_list->CmdBuffer.Data + retained.CmdBegin, retained.CmdBuffer.Data, ( size_t )retained.CmdBuffer.size_in_bytes() );
+    draw_list->CmdBuffer.Size += retained.CmdBuffer.Size;
+    draw_list->VtxBuffer.reserve( retained.VtxBegin + retained.VtxBuffer.Size );
+    memcpy( draw_list->VtxBuffer.Data + retained.VtxBegin, retained.VtxBuffer.Data, ( size_t )retained.VtxBuffer.size_in_bytes() );
+    draw_list->VtxBuffer.Size += retained.VtxBuffer.Size;
+    draw_list->IdxBuffer.reserve( retained.IdxBegin + retained.IdxBuffer.Size );
+    memcpy( draw_list->IdxBuffer.Data + retained.IdxBegin, retained.IdxBuffer.Data, ( size_t )retained.IdxBuffer.size_in_bytes() );
+    draw_list->IdxBuffer.Size += retained.IdxBuffer.Size;
+    draw_list->_VtxWritePtr = draw_list->VtxBuffer.Data + draw_list->VtxBuffer.Size;
+    draw_list->_IdxWritePtr = draw_list->IdxBuffer.Data + draw_list->IdxBuffer.Size;
+    draw_list->_VtxCurrentIdx = retained.VtxCurrentIdx;
+    draw_list->_CmdHeader = retained.CmdHeader;
+    window->DC.CursorMaxPos = ImMax( window->DC.CursorMaxPos, retained.CursorMaxPos );
+    window->DC.NavLayerActiveMaskNext |= retained.NavLayerActiveMaskNext;
+    return true;
+  }
+
+  retained.Key = 0;
+  retained.RecordingKey = key;
+  retained.VtxBegin = draw_list->VtxBuffer.Size;
+  retained.IdxBegin = draw_list->IdxBuffer.Size;
+  retained.CmdBegin = draw_list->CmdBuffer.Size - 1;
+  retained.ClipRectStackSize = draw_list->_ClipRectStack.Size;
+  retained.TextureIdStackSize = draw_list->_TextureIdStack.Size;
+  return false;
+}
+
+// Called from End() and Begin(): keep what the contents appended, unless they can't be put back as they are
+static void EndRetainedWindowContents( ImGuiWindow *window, bool keep ) {
+  ImGuiWindowRetained &retained = window->Retained;
+  ImDrawList *draw_list = window->DrawList;
+  const ImU32 key = retained.RecordingKey;
+  retained.RecordingKey = 0;
+
+  if( !keep || window->DC.CurrentColumns != NULL || draw_list->_Splitter._Count > 1 || draw_list->_Path.Size != 0 ) {
+    return;
+  }
+
+  // Unbalanced clip rectangles or textures, or the current command merged into a previous one
+  if( draw_list->_ClipRectStack.Size != retained.ClipRectStackSize || draw_list->_TextureIdStack.Size != retained.TextureIdStackSize || draw_list->CmdBuffer.Size <= retained.CmdBegin ) {
+    return;
+  }
+
+  retained.CmdBuffer.resize( draw_list->CmdBuffer.Size - retained.CmdBegin );
+  memcpy( retained.CmdBuffer.Data, draw_list->CmdBuffer.Data + retained.CmdBegin, ( size_t )retained.CmdBuffer.size_in_bytes() );
+  retained.VtxBuffer.resize( draw_list->VtxBuffer.Size - retained.VtxBegin );
+  memcpy( retained.VtxBuffer.Data, draw_list->VtxBuffer.Data + retained.VtxBegin, ( size_t )retained.VtxBuffer.size_in_bytes() );
+  retained.IdxBuffer.resize( draw_list->IdxBuffer.Size - retained.IdxBegin );
+  memcpy( retained.IdxBuffer.Data, draw_list->IdxBuffer.Data + retained.IdxBegin, ( size_t )retained.IdxBuffer.size_in_bytes() );
+  retained.VtxCurrentIdx = draw_list->_VtxCurrentIdx;
+  retained.CmdHeader = draw_list->_CmdHeader;
+  retained.CursorMaxPos = window->DC.CursorMaxPos;
+  retained.NavLayerActiveMaskNext = window->DC.NavLayerActiveMaskNext;
+  retained.Key = key;
+}
+
 void ImGui::End() {
   ImGuiContext &g = *GImGui;
   ImGuiWindow *window = g.CurrentWindow;
@@ -6736,6 +7041,11 @@ void ImGui::End() {
     IM_ASSERT_USER_ERROR( g.WithinEndChild, "Must call EndChild() and not End()!" );
   }
 
+  // Record retained contents before anything else gets appended
+  if( window->Retained.RecordingKey != 0 ) {
+    EndRetainedWindowContents( window, true );
+  }
+
   // Close anything that is open
   if( window->DC.CurrentColumns ) {
     EndColumns();
@@ -11658,12 +11968,33 @@ void ImGui::ShowMetricsWindow( bool *p_open ) {
     }
 
     static void NodeStorage( ImGuiStorage *storage, const char *label ) {
-      if( !ImGui::TreeNode( label, "%s: %d entries, %d bytes", label, storage->Data.Size, storage->Data.size_in_bytes() ) ) {
+#ifdef IMGUI_USE_HASHED_STORAGE
+      const int entries = storage->Count + ( storage->HasZeroPair ? 1 : 0 );
+#else
+      const int entries = storage->Data.Size;
+#endif
+
+      if( !ImGui::TreeNode( label, "%s: %d entries, %d bytes", label, entries, storage->Data.size_in_bytes() ) ) {
         return;
       }
 
+#ifdef IMGUI_USE_HASHED_STORAGE
+
+      if( storage->HasZeroPair ) {
+        ImGui::BulletText( "Key 0x%08X Value { i: %d }", storage->ZeroPair.key, storage->ZeroPair.val_i );
+      }
+
+#endif
+
       for( int n = 0; n < storage->Data.Size; n++ ) {
         const ImGuiStorage::ImGuiStoragePair &p = storage->Data[n];
+#ifdef IMGUI_USE_HASHED_STORAGE
+
+        if( p.key == 0 ) {
+          continue;
+        }
+
+#endif
         ImGui::BulletText( "Key 0x%08X Value { i: %d }", p.key, p.val_i ); // Important: we currently don't store a type, real value may not be integer.
       }
 
@@ -308,6 +308,16 @@ namespace ImGui {
   IMGUI_API bool          BeginChild( ImGuiID id, const ImVec2 &size = ImVec2( 0, 0 ), bool border = false, ImGuiWindowFlags flags = 0 );
   IMGUI_API void          EndChild();
 
+  // Retained Window Contents
+  // - Opt-in: call right after Begin()/BeginChild() with a hash of everything the contents depend on besides the window itself
+  //   (text, selection, colors, anything that changes over time). Position, size, scroll, focus, fonts and the mouse position over
+  //   the window are folded in for you.
+  // - Returns true when the contents drawn on the previous frame were put back in the draw list as they were. Skip submitting them, but
+  //   still call End()/EndChild(). Returns false otherwise: submit them as usual, they are recorded until End() for the next frame.
+  // - Nothing is reused while the window receives mouse buttons, wheel or keyboard input, has an active item or is appearing. Contents
+  //   that open windows of their own (child windows, tooltips, popups) are never recorded, as skipping them would close those.
+  IMGUI_API bool          RetainWindowContents( ImU32 contents_hash );
+
   // Windows Utilities
   // - 'current window' = the window we are appending into while inside a Begin()/End() block. 'next window' = next window we will Begin() into.
   IMGUI_API bool          IsWindowAppearing();
@@ -2148,12 +2158,28 @@ struct ImGuiStorage {
   };
 
   ImVector<ImGuiStoragePair>      Data;
+#ifdef IMGUI_USE_HASHED_STORAGE
+  // With IMGUI_USE_HASHED_STORAGE, Data is an open addressing table (power of two size, linear probing) where key 0 marks a free slot.
+  // The pair of key 0 is kept aside in ZeroPair. Skip pairs of key 0 when iterating Data.
+  int                             Count;          // Used slots of Data
+  bool                            HasZeroPair;
+  ImGuiStoragePair                ZeroPair;
 
-  // - Get***() functions find pair, never add/allocate. Pairs are sorted so a query is O(log N)
+  ImGuiStorage() : ZeroPair( 0, 0 ) {
+    Count = 0;
+    HasZeroPair = false;
+  }
+#endif
+
+  // - Get***() functions find pair, never add/allocate. Pairs are sorted so a query is O(log N), or hashed with IMGUI_USE_HASHED_STORAGE so a query is O(1).
   // - Set***() functions find pair, insertion on demand if missing.
   // - Sorted insertion is costly, paid once. A typical frame shouldn't need to insert any new pair.
   void                Clear() {
     Data.clear();
+#ifdef IMGUI_USE_HASHED_STORAGE
+    Count = 0;
+    HasZeroPair = false;
+#endif
   }
   IMGUI_API int       GetInt( ImGuiID key, int default_val = 0 ) const;
   IMGUI_API void      SetInt( ImGuiID key, int val );
@@ -2177,6 +2203,7 @@ struct ImGuiStorage {
   IMGUI_API void      SetAllInt( int val );
 
   // For quicker full rebuild of a storage (instead of an incremental one), you may add all your contents and then sort once.
+  // With IMGUI_USE_HASHED_STORAGE this rehashes the pairs pushed into an empty (or resized to 0) storage instead.
   IMGUI_API void      BuildSortByKey();
 };
 
@@ -2571,6 +2598,7 @@ struct ImDrawList {
   IMGUI_API void  _OnChangedClipRect();
   IMGUI_API void  _OnChangedTextureID();
   IMGUI_API void  _OnChangedVtxOffset();
+  IMGUI_API void  _PathCircle( const ImVec2 &center, float radius, int num_segments );
 };
 
 // All draw data to render a Dear ImGui frame
@@ -354,6 +354,10 @@ ImDrawListSharedData::ImDrawListSharedData() {
 
   memset( CircleSegmentCounts, 0, sizeof( CircleSegmentCounts ) ); // This will be set by SetCircleSegmentMaxError()
   TexUvLines = NULL;
+
+  for( int i = 0; i < IM_ARRAYSIZE( CircleVtxOffsets ); i++ ) {
+    CircleVtxOffsets[i] = -1;
+  }
 }
 
 void ImDrawListSharedData::SetCircleSegmentMaxError( float max_error ) {
@@ -370,6 +374,158 @@ void ImDrawListSharedData::SetCircleSegmentMaxError( float max_error ) {
   }
 }
 
+const ImVec2 *ImDrawListSharedData::GetCircleVtx( int num_segments ) const {
+  IM_ASSERT( num_segments >= 3 && num_segments <= IM_DRAWLIST_CIRCLE_AUTO_SEGMENT_MAX );
+
+  if( CircleVtxOffsets[num_segments] < 0 ) {
+    // Same angles as PathArcTo( center, radius, 0.0f, a_max, num_segments - 1 ) with the a_max used for closed shapes
+    const float a_max = ( IM_PI * 2.0f ) * ( ( float )num_segments - 1.0f ) / ( float )num_segments;
+    CircleVtxOffsets[num_segments] = CircleVtx.Size;
+    CircleVtx.resize( CircleVtx.Size + num_segments );
+    ImVec2 *out = CircleVtx.Data + CircleVtxOffsets[num_segments];
+
+    for( int i = 0; i < num_segments; i++ ) {
+      const float a = ( ( float )i / ( float )( num_segments - 1 ) ) * a_max;
+      out[i] = ImVec2( ImCos( a ), ImSin( a ) );
+    }
+  }
+
+  return CircleVtx.Data + CircleVtxOffsets[num_segments];
+}
+
+void ImDrawTextRunCache::Clear() {
+  Map.Clear();
+  Runs.clear();
+  Text.clear();
+  Quads.clear();
+}
+
+void ImDrawTextRunCache::NewFrame( ImTextureID tex_id ) {
+  if( TexID != tex_id ) {
+    Clear();
+    TexID = tex_id;
+  }
+
+  if( ++Frame % IM_DRAWLIST_TEXT_RUN_MAX_AGE != 0 ) {
+    return;
+  }
+
+  // Compact the runs drawn since the last pass, in place since they keep their order
+  int text_size = 0;
+  int quads_size = 0;
+  int runs_size = 0;
+  Map.Data.resize( 0 );
+
+  for( int i = 0; i < Runs.Size; i++ ) {
+    ImDrawTextRun run = Runs[i];
+
+    if( run.LastFrame <= Frame - IM_DRAWLIST_TEXT_RUN_MAX_AGE ) {
+      continue;
+    }
+
+    memmove( Text.Data + text_size, Text.Data + run.TextOffset, ( size_t )run.TextLength );
+    memmove( Quads.Data + quads_size, Quads.Data + run.QuadOffset, ( size_t )run.QuadCount * 2 * sizeof( ImVec4 ) );
+    run.TextOffset = text_size;
+    run.QuadOffset = quads_size;
+    text_size += run.TextLength;
+    quads_size += run.QuadCount * 2;
+    Runs[runs_size++] = run;
+    Map.Data.push_back( ImGuiStorage::ImGuiStoragePair( run.Key, runs_size ) );
+  }
+
+  Runs.resize( runs_size );
+  Text.resize( text_size );
+  Quads.resize( quads_size );
+  Map.BuildSortByKey();
+}
+
+const ImDrawTextRun *ImDrawTextRunCache::GetRun( const ImFont *font, float size, const char *text_begin, const char *text_end ) {
+  const int text_length = ( int )( text_end - text_begin );
+  ImGuiID key = ImHashData( &font, sizeof( font ) );
+  key = ImHashData( &size, sizeof( size ), key );
+  key = ImHashData( text_begin, ( size_t )text_length, key );
+  const int index = Map.GetInt( key ) - 1;
+
+  if( index >= 0 ) {
+    ImDrawTextRun &run = Runs[index];
+
+    if( run.Font != font || run.Size != size || run.TextLength != text_length || memcmp( Text.Data + run.TextOffset, text_begin, ( size_t )text_length ) != 0 ) {
+      return NULL; // Hash collision, the run already cached keeps its slot
+    }
+
+    run.LastFrame = Frame;
+    return &run;
+  }
+
+  if( Runs.Size >= IM_DRAWLIST_TEXT_RUN_MAX_COUNT ) {
+    return NULL;
+  }
+
+  ImDrawTextRun run;
+  run.Key = key;
+  run.Font = font;
+  run.Size = size;
+  run.TextOffset = Text.Size;
+  run.TextLength = text_length;
+  run.QuadOffset = Quads.Size;
+  run.Bounds = ImVec4( FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX );
+  run.LastFrame = Frame;
+  Text.resize( Text.Size + text_length );
+  memcpy( Text.Data + run.TextOffset, text_begin, ( size_t )text_length );
+
+  // Same walk as ImFont::RenderText() without wrapping and clipping, from the origin
+  const float scale = size / font->FontSize;
+  const float line_height = font->FontSize * scale;
+  float x = 0.0f;
+  float y = 0.0f;
+
+  for( const char *s = text_begin; s < text_end; ) {
+    unsigned int c = ( unsigned int ) * s;
+
+    if( c < 0x80 ) {
+      s += 1;
+    } else {
+      s += ImTextCharFromUtf8( &c, s, text_end );
+
+      if( c == 0 ) { // Malformed UTF-8?
+        break;
+      }
+    }
+
+    if( c < 32 ) {
+      if( c == '\n' ) {
+        x = 0.0f;
+        y += line_height;
+        continue;
+      }
+
+      if( c == '\r' ) {
+        continue;
+      }
+    }
+
+    const ImFontGlyph *glyph = font->FindGlyph( ( ImWchar )c );
+
+    if( glyph == NULL ) {
+      continue;
+    }
+
+    if( glyph->Visible ) {
+      const ImVec4 pos( x + glyph->X0 * scale, y + glyph->Y0 * scale, x + glyph->X1 * scale, y + glyph->Y1 * scale );
+      Quads.push_back( pos );
+      Quads.push_back( ImVec4( glyph->U0, glyph->V0, glyph->U1, glyph->V1 ) );
+      run.Bounds = ImVec4( ImMin( run.Bounds.x, pos.x ), ImMin( run.Bounds.y, pos.y ), ImMax( run.Bounds.z, pos.z ), ImMax( run.Bounds.w, pos.w ) );
+    }
+
+    x += glyph->AdvanceX * scale;
+  }
+
+  run.QuadCount = ( Quads.Size - run.QuadOffset ) / 2;
+  Runs.push_back( run );
+  Map.SetInt( key, Runs.Size );
+  return &Runs.back();
+}
+
 // Initialize before use in a new frame. We always have a command ready in the buffer.
 void ImDrawList::_ResetForNewFrame() {
   // Verify that the ImDrawCmd fields we want to memcmp() are contiguous in memory.
@@ -696,6 +852,171 @@ void ImDrawList::PrimQuadUV( const ImVec2 &a, const ImVec2 &b, const ImVec2 &c,
 #define IM_NORMALIZE2F_OVER_ZERO(VX,VY)     do { float d2 = VX*VX + VY*VY; if (d2 > 0.0f) { float inv_len = 1.0f / ImSqrt(d2); VX *= inv_len; VY *= inv_len; } } while (0)
 #define IM_FIXNORMAL2F(VX,VY)               do { float d2 = VX*VX + VY*VY; if (d2 < 0.5f) d2 = 0.5f; float inv_lensq = 1.0f / d2; VX *= inv_lensq; VY *= inv_lensq; } while (0)
 
+// 4-wide float operations for the AddPolyline() kernels, selected at compile time. They work on 2 ImVec2 at a time
+// and only use IEEE exact operations (no reciprocal estimates, no fused multiply-add) so they give the scalar results.
+#if defined(IMGUI_DISABLE_SIMD)
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+typedef __m128 ImFloat4;
+#define IM_F4_LOAD(P)                   _mm_loadu_ps(P)
+#define IM_F4_STORE(P,V)                _mm_storeu_ps(P,V)
+#define IM_F4_SET(X,Y,Z,W)              _mm_setr_ps(X,Y,Z,W)
+#define IM_F4_SET1(X)                   _mm_set1_ps(X)
+#define IM_F4_ADD(A,B)                  _mm_add_ps(A,B)
+#define IM_F4_SUB(A,B)                  _mm_sub_ps(A,B)
+#define IM_F4_MUL(A,B)                  _mm_mul_ps(A,B)
+#define IM_F4_DIV(A,B)                  _mm_div_ps(A,B)
+#define IM_F4_SQRT(A)                   _mm_sqrt_ps(A)
+#define IM_F4_SWAP_XY(A)                _mm_shuffle_ps(A,A,_MM_SHUFFLE(2,3,0,1))
+#define IM_F4_LOW_HALVES(A,B)           _mm_movelh_ps(A,B)
+#define IM_F4_HIGH_HALVES(A,B)          _mm_movehl_ps(B,A)
+#define IM_F4_SELECT_GT(A,B,T,F)        _mm_or_ps(_mm_and_ps(_mm_cmpgt_ps(A,B),T), _mm_andnot_ps(_mm_cmpgt_ps(A,B),F))
+#define IMGUI_POLYLINE_SIMD
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+typedef v128_t ImFloat4;
+#define IM_F4_LOAD(P)                   wasm_v128_load(P)
+#define IM_F4_STORE(P,V)                wasm_v128_store(P,V)
+#define IM_F4_SET(X,Y,Z,W)              wasm_f32x4_make(X,Y,Z,W)
+#define IM_F4_SET1(X)                   wasm_f32x4_splat(X)
+#define IM_F4_ADD(A,B)                  wasm_f32x4_add(A,B)
+#define IM_F4_SUB(A,B)                  wasm_f32x4_sub(A,B)
+#define IM_F4_MUL(A,B)                  wasm_f32x4_mul(A,B)
+#define IM_F4_DIV(A,B)                  wasm_f32x4_div(A,B)
+#define IM_F4_SQRT(A)                   wasm_f32x4_sqrt(A)
+#define IM_F4_SWAP_XY(A)                wasm_i32x4_shuffle(A,A,1,0,3,2)
+#define IM_F4_LOW_HALVES(A,B)           wasm_i32x4_shuffle(A,B,0,1,4,5)
+#define IM_F4_HIGH_HALVES(A,B)          wasm_i32x4_shuffle(A,B,2,3,6,7)
+#define IM_F4_SELECT_GT(A,B,T,F)        wasm_v128_bitselect(T,F,wasm_f32x4_gt(A,B))
+#define IMGUI_POLYLINE_SIMD
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+typedef float32x4_t ImFloat4;
+static inline ImFloat4 ImFloat4Set( float x, float y, float z, float w ) {
+  const float v[4] = { x, y, z, w };
+  return vld1q_f32( v );
+}
+#define IM_F4_LOAD(P)                   vld1q_f32(P)
+#define IM_F4_STORE(P,V)                vst1q_f32(P,V)
+#define IM_F4_SET(X,Y,Z,W)              ImFloat4Set(X,Y,Z,W)
+#define IM_F4_SET1(X)                   vdupq_n_f32(X)
+#define IM_F4_ADD(A,B)                  vaddq_f32(A,B)
+#define IM_F4_SUB(A,B)                  vsubq_f32(A,B)
+#define IM_F4_MUL(A,B)                  vmulq_f32(A,B)
+#define IM_F4_DIV(A,B)                  vdivq_f32(A,B)
+#define IM_F4_SQRT(A)                   vsqrtq_f32(A)
+#define IM_F4_SWAP_XY(A)                vrev64q_f32(A)
+#define IM_F4_LOW_HALVES(A,B)           vcombine_f32(vget_low_f32(A), vget_low_f32(B))
+#define IM_F4_HIGH_HALVES(A,B)          vcombine_f32(vget_high_f32(A), vget_high_f32(B))
+#define IM_F4_SELECT_GT(A,B,T,F)        vbslq_f32(vcgtq_f32(A,B),T,F)
+#define IMGUI_POLYLINE_SIMD
+#endif
+
+// Normal of the segment p1 -> p2, same as IM_NORMALIZE2F_OVER_ZERO() of the direction turned by 90 degrees
+static inline void ImPolylineNormal( const ImVec2 &p1, const ImVec2 &p2, ImVec2 *out_normal ) {
+  float dx = p2.x - p1.x;
+  float dy = p2.y - p1.y;
+  IM_NORMALIZE2F_OVER_ZERO( dx, dy );
+  out_normal->x = dy;
+  out_normal->y = -dx;
+}
+
+// Normals of the segments points[i] -> points[i + 1] for i in [0, count)
+static void ImPolylineNormals( const ImVec2 *points, ImVec2 *out_normals, int count ) {
+  int i = 0;
+#ifdef IMGUI_POLYLINE_SIMD
+  const ImFloat4 zero = IM_F4_SET1( 0.0f );
+  const ImFloat4 one = IM_F4_SET1( 1.0f );
+  const ImFloat4 turn = IM_F4_SET( 1.0f, -1.0f, 1.0f, -1.0f );
+
+  for( ; i + 2 <= count; i += 2 ) {
+    ImFloat4 d = IM_F4_SUB( IM_F4_LOAD( &points[i + 1].x ), IM_F4_LOAD( &points[i].x ) ); // dx0 dy0 dx1 dy1
+    ImFloat4 d_sq = IM_F4_MUL( d, d );
+    ImFloat4 d2 = IM_F4_ADD( d_sq, IM_F4_SWAP_XY( d_sq ) );
+    ImFloat4 inv_len = IM_F4_DIV( one, IM_F4_SQRT( d2 ) );
+    d = IM_F4_SELECT_GT( d2, zero, IM_F4_MUL( d, inv_len ), d );
+    IM_F4_STORE( &out_normals[i].x, IM_F4_MUL( IM_F4_SWAP_XY( d ), turn ) ); // dy0 -dx0 dy1 -dx1
+  }
+
+#endif
+
+  for( ; i < count; i++ ) {
+    ImPolylineNormal( points[i], points[i + 1], &out_normals[i] );
+  }
+}
+
+// Edge points of one line point from the normals of the segments before and after it, same as IM_FIXNORMAL2F() of their average.
+// Writes p + o, p - o (2 edges) or p + o, p + i, p - i, p - o (4 edges), with o and i the offsets to the outer and inner edges.
+static inline void ImPolylineEdge( const ImVec2 &p, const ImVec2 &n1, const ImVec2 &n2, ImVec2 *out_edges, float half_outer, float half_inner, bool four_edges ) {
+  float dm_x = ( n1.x + n2.x ) * 0.5f;
+  float dm_y = ( n1.y + n2.y ) * 0.5f;
+  IM_FIXNORMAL2F( dm_x, dm_y );
+  const float dm_out_x = dm_x * half_outer;
+  const float dm_out_y = dm_y * half_outer;
+
+  if( four_edges ) {
+    const float dm_in_x = dm_x * half_inner;
+    const float dm_in_y = dm_y * half_inner;
+    out_edges[0].x = p.x + dm_out_x;
+    out_edges[0].y = p.y + dm_out_y;
+    out_edges[1].x = p.x + dm_in_x;
+    out_edges[1].y = p.y + dm_in_y;
+    out_edges[2].x = p.x - dm_in_x;
+    out_edges[2].y = p.y - dm_in_y;
+    out_edges[3].x = p.x - dm_out_x;
+    out_edges[3].y = p.y - dm_out_y;
+  } else {
+    out_edges[0].x = p.x + dm_out_x;
+    out_edges[0].y = p.y + dm_out_y;
+    out_edges[1].x = p.x - dm_out_x;
+    out_edges[1].y = p.y - dm_out_y;
+  }
+}
+
+// Edge points of points[i] for i in [begin, end), begin > 0, from normals[i - 1] and normals[i]
+static void ImPolylineEdges( const ImVec2 *points, const ImVec2 *normals, ImVec2 *out_edges, int begin, int end, float half_outer, float half_inner, bool four_edges ) {
+  const int stride = four_edges ? 4 : 2;
+  int i = begin;
+#ifdef IMGUI_POLYLINE_SIMD
+  const ImFloat4 half = IM_F4_SET1( 0.5f );
+  const ImFloat4 one = IM_F4_SET1( 1.0f );
+  const ImFloat4 outer = IM_F4_SET1( half_outer );
+  const ImFloat4 inner = IM_F4_SET1( half_inner );
+
+  for( ; i + 2 <= end; i += 2 ) {
+    ImFloat4 dm = IM_F4_MUL( IM_F4_ADD( IM_F4_LOAD( &normals[i - 1].x ), IM_F4_LOAD( &normals[i].x ) ), half );
+    ImFloat4 dm_sq = IM_F4_MUL( dm, dm );
+    ImFloat4 d2 = IM_F4_ADD( dm_sq, IM_F4_SWAP_XY( dm_sq ) );
+    d2 = IM_F4_SELECT_GT( half, d2, half, d2 );
+    dm = IM_F4_MUL( dm, IM_F4_DIV( one, d2 ) );
+
+    const ImFloat4 p = IM_F4_LOAD( &points[i].x );
+    const ImFloat4 dm_out = IM_F4_MUL( dm, outer );
+    const ImFloat4 out_pos = IM_F4_ADD( p, dm_out );
+    const ImFloat4 out_neg = IM_F4_SUB( p, dm_out );
+    float *out = &out_edges[i * stride].x;
+
+    if( four_edges ) {
+      const ImFloat4 dm_in = IM_F4_MUL( dm, inner );
+      const ImFloat4 in_pos = IM_F4_ADD( p, dm_in );
+      const ImFloat4 in_neg = IM_F4_SUB( p, dm_in );
+      IM_F4_STORE( out + 0, IM_F4_LOW_HALVES( out_pos, in_pos ) );
+      IM_F4_STORE( out + 4, IM_F4_LOW_HALVES( in_neg, out_neg ) );
+      IM_F4_STORE( out + 8, IM_F4_HIGH_HALVES( out_pos, in_pos ) );
+      IM_F4_STORE( out + 12, IM_F4_HIGH_HALVES( in_neg, out_neg ) );
+    } else {
+      IM_F4_STORE( out + 0, IM_F4_LOW_HALVES( out_pos, out_neg ) );
+      IM_F4_STORE( out + 4, IM_F4_HIGH_HALVES( out_pos, out_neg ) );
+    }
+  }
+
+#endif
+
+  for( ; i < end; i++ ) {
+    ImPolylineEdge( points[i], normals[i - 1], normals[i], &out_edges[i * stride], half_outer, half_inner, four_edges );
+  }
+}
+
 // TODO: Thickness anti-aliased lines cap are missing their AA fringe.
 // We avoid using the ImVec2 math operators here to reduce cost to a minimum for debug/non-inlined builds.
 void ImDrawList::AddPolyline( const ImVec2 *points, const int points_count, ImU32 col, bool closed, float thickness ) {
@@ -735,16 +1056,11 @@ void ImDrawList::AddPolyline( const ImVec2 *points, const int points_count, ImU3
     ImVec2 *temp_points = temp_normals + points_count;
 
     // Calculate normals (tangents) for each line segment
-    for( int i1 = 0; i1 < count; i1++ ) {
-      const int i2 = ( i1 + 1 ) == points_count ? 0 : i1 + 1;
-      float dx = points[i2].x - points[i1].x;
-      float dy = points[i2].y - points[i1].y;
-      IM_NORMALIZE2F_OVER_ZERO( dx, dy );
-      temp_normals[i1].x = dy;
-      temp_normals[i1].y = -dx;
-    }
+    ImPolylineNormals( points, temp_normals, points_count - 1 );
 
-    if( !closed ) {
+    if( closed ) {
+      ImPolylineNormal( points[points_count - 1], points[0], &temp_normals[points_count - 1] );
+    } else {
       temp_normals[points_count - 1] = temp_normals[points_count - 2];
     }
 
@@ -768,29 +1084,20 @@ void ImDrawList::AddPolyline( const ImVec2 *points, const int points_count, ImU3
         temp_points[( points_count - 1 ) * 2 + 1] = points[points_count - 1] - temp_normals[points_count - 1] * half_draw_size;
       }
 
-      // Generate the indices to form a number of triangles for each line segment, and the vertices for the line edges
-      // This takes points n and n+1 and writes into n+1, with the first point in a closed line being generated from the final one (as n+1 wraps)
-      // FIXME-OPT: Merge the different loops, possibly remove the temporary buffer.
+      // Add temporary vertexes for the outer edges, at the end point of each segment
+      ImPolylineEdges( points, temp_normals, temp_points, 1, points_count, half_draw_size, 0.0f, false );
+
+      if( closed ) {
+        ImPolylineEdge( points[0], temp_normals[points_count - 1], temp_normals[0], &temp_points[0], half_draw_size, 0.0f, false );
+      }
+
+      // Generate the indices to form a number of triangles for each line segment
+      // This takes points n and n+1, with the end of the last segment in a closed line being the first point (as n+1 wraps)
       unsigned int idx1 = _VtxCurrentIdx; // Vertex index for start of line segment
 
       for( int i1 = 0; i1 < count; i1++ ) { // i1 is the first point of the line segment
-        const int i2 = ( i1 + 1 ) == points_count ? 0 : i1 + 1; // i2 is the second point of the line segment
         const unsigned int idx2 = ( ( i1 + 1 ) == points_count ) ? _VtxCurrentIdx : ( idx1 + ( use_texture ? 2 : 3 ) ); // Vertex index for end of segment
 
-        // Average normals
-        float dm_x = ( temp_normals[i1].x + temp_normals[i2].x ) * 0.5f;
-        float dm_y = ( temp_normals[i1].y + temp_normals[i2].y ) * 0.5f;
-        IM_FIXNORMAL2F( dm_x, dm_y );
-        dm_x *= half_draw_size; // dm_x, dm_y are offset to the outer edge of the AA area
-        dm_y *= half_draw_size;
-
-        // Add temporary vertexes for the outer edges
-        ImVec2 *out_vtx = &temp_points[i2 * 2];
-        out_vtx[0].x = points[i2].x + dm_x;
-        out_vtx[0].y = points[i2].y + dm_y;
-        out_vtx[1].x = points[i2].x - dm_x;
-        out_vtx[1].y = points[i2].y - dm_y;
-
         if( use_texture ) {
           // Add indices for two triangles
           _IdxWritePtr[0] = ( ImDrawIdx )( idx2 + 0 );
@@ -877,35 +1184,20 @@ void ImDrawList::AddPolyline( const ImVec2 *points, const int points_count, ImU3
         temp_points[points_last * 4 + 3] = points[points_last] - temp_normals[points_last] * ( half_inner_thickness + AA_SIZE );
       }
 
-      // Generate the indices to form a number of triangles for each line segment, and the vertices for the line edges
-      // This takes points n and n+1 and writes into n+1, with the first point in a closed line being generated from the final one (as n+1 wraps)
-      // FIXME-OPT: Merge the different loops, possibly remove the temporary buffer.
+      // Add temporary vertices, at the end point of each segment
+      ImPolylineEdges( points, temp_normals, temp_points, 1, points_count, half_inner_thickness + AA_SIZE, half_inner_thickness, true );
+
+      if( closed ) {
+        ImPolylineEdge( points[0], temp_normals[points_count - 1], temp_normals[0], &temp_points[0], half_inner_thickness + AA_SIZE, half_inner_thickness, true );
+      }
+
+      // Generate the indices to form a number of triangles for each line segment
+      // This takes points n and n+1, with the end of the last segment in a closed line being the first point (as n+1 wraps)
       unsigned int idx1 = _VtxCurrentIdx; // Vertex index for start of line segment
 
       for( int i1 = 0; i1 < count; i1++ ) { // i1 is the first point of the line segment
-        const int i2 = ( i1 + 1 ) == points_count ? 0 : ( i1 + 1 ); // i2 is the second point of the line segment
         const unsigned int idx2 = ( i1 + 1 ) == points_count ? _VtxCurrentIdx : ( idx1 + 4 ); // Vertex index for end of segment
 
-        // Average normals
-        float dm_x = ( temp_normals[i1].x + temp_normals[i2].x ) * 0.5f;
-        float dm_y = ( temp_normals[i1].y + temp_normals[i2].y ) * 0.5f;
-        IM_FIXNORMAL2F( dm_x, dm_y );
-        float dm_out_x = dm_x * ( half_inner_thickness + AA_SIZE );
-        float dm_out_y = dm_y * ( half_inner_thickness + AA_SIZE );
-        float dm_in_x = dm_x * half_inner_thickness;
-        float dm_in_y = dm_y * half_inner_thickness;
-
-        // Add temporary vertices
-        ImVec2 *out_vtx = &temp_points[i2 * 4];
-        out_vtx[0].x = points[i2].x + dm_out_x;
-        out_vtx[0].y = points[i2].y + dm_out_y;
-        out_vtx[1].x = points[i2].x + dm_in_x;
-        out_vtx[1].y = points[i2].y + dm_in_y;
-        out_vtx[2].x = points[i2].x - dm_in_x;
-        out_vtx[2].y = points[i2].y - dm_in_y;
-        out_vtx[3].x = points[i2].x - dm_out_x;
-        out_vtx[3].y = points[i2].y - dm_out_y;
-
         // Add indexes
         _IdxWritePtr[0]  = ( ImDrawIdx )( idx2 + 1 );
         _IdxWritePtr[1]  = ( ImDrawIdx )( idx1 + 1 );
@@ -1129,6 +1421,26 @@ void ImDrawList::PathArcTo( const ImVec2 &center, float radius, float a_min, flo
   }
 }
 
+// Closed shape with num_segments points (the last one is not repeated), using the unit circle tables instead of ImCos()/ImSin() per point
+void ImDrawList::_PathCircle( const ImVec2 &center, float radius, int num_segments ) {
+  if( radius == 0.0f || num_segments < 3 || num_segments > IM_DRAWLIST_CIRCLE_AUTO_SEGMENT_MAX ) {
+    // Because we are filling a closed shape we remove 1 from the count of segments/points
+    const float a_max = ( IM_PI * 2.0f ) * ( ( float )num_segments - 1.0f ) / ( float )num_segments;
+    PathArcTo( center, radius, 0.0f, a_max, num_segments - 1 );
+    return;
+  }
+
+  const ImVec2 *unit = _Data->GetCircleVtx( num_segments );
+  const int path_size = _Path.Size;
+  _Path.resize( path_size + num_segments );
+  ImVec2 *out = _Path.Data + path_size;
+
+  for( int i = 0; i < num_segments; i++ ) {
+    out[i].x = center.x + unit[i].x * radius;
+    out[i].y = center.y + unit[i].y * radius;
+  }
+}
+
 ImVec2 ImBezierCalc( const ImVec2 &p1, const ImVec2 &p2, const ImVec2 &p3, const ImVec2 &p4, float t ) {
   float u = 1.0f - t;
   float w1 = u * u * u;
@@ -1138,35 +1450,51 @@ ImVec2 ImBezierCalc( const ImVec2 &p1, const ImVec2 &p2, const ImVec2 &p3, const
   return ImVec2( w1 * p1.x + w2 * p2.x + w3 * p3.x + w4 * p4.x, w1 * p1.y + w2 * p2.y + w3 * p3.y + w4 * p4.y );
 }
 
-// Closely mimics BezierClosestPointCasteljauStep() in imgui.cpp
-static void PathBezierToCasteljau( ImVector<ImVec2> *path, float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4, float tess_tol, int level ) {
-  float dx = x4 - x1;
-  float dy = y4 - y1;
-  float d2 = ( ( x2 - x4 ) * dy - ( y2 - y4 ) * dx );
-  float d3 = ( ( x3 - x4 ) * dy - ( y3 - y4 ) * dx );
-  d2 = ( d2 >= 0 ) ? d2 : -d2;
-  d3 = ( d3 >= 0 ) ? d3 : -d3;
+// Appends num_segments points of the curve after p1 with forward differences, the last one is exactly p4
+static void PathBezierToForwardDifferences( ImVector<ImVec2> *path, const ImVec2 &p1, const ImVec2 &p2, const ImVec2 &p3, const ImVec2 &p4, int num_segments ) {
+  // Power basis: B(t) = a * t^3 + b * t^2 + c * t + p1
+  const ImVec2 a( p4.x - p1.x + 3.0f * ( p2.x - p3.x ), p4.y - p1.y + 3.0f * ( p2.y - p3.y ) );
+  const ImVec2 b( 3.0f * ( p1.x - 2.0f * p2.x + p3.x ), 3.0f * ( p1.y - 2.0f * p2.y + p3.y ) );
+  const ImVec2 c( 3.0f * ( p2.x - p1.x ), 3.0f * ( p2.y - p1.y ) );
+  const float h = 1.0f / ( float )num_segments;
+  const float h2 = h * h;
+  const float h3 = h2 * h;
+
+  // First, second and third differences of B() at t = 0 for a step of h
+  ImVec2 d1( a.x * h3 + b.x * h2 + c.x * h, a.y * h3 + b.y * h2 + c.y * h );
+  ImVec2 d2( 6.0f * a.x * h3 + 2.0f * b.x * h2, 6.0f * a.y * h3 + 2.0f * b.y * h2 );
+  const ImVec2 d3( 6.0f * a.x * h3, 6.0f * a.y * h3 );
 
-  if( ( d2 + d3 ) * ( d2 + d3 ) < tess_tol * ( dx * dx + dy * dy ) ) {
-    path->push_back( ImVec2( x4, y4 ) );
-  } else if( level < 10 ) {
-    float x12 = ( x1 + x2 ) * 0.5f,       y12 = ( y1 + y2 ) * 0.5f;
-    float x23 = ( x2 + x3 ) * 0.5f,       y23 = ( y2 + y3 ) * 0.5f;
-    float x34 = ( x3 + x4 ) * 0.5f,       y34 = ( y3 + y4 ) * 0.5f;
-    float x123 = ( x12 + x23 ) * 0.5f,    y123 = ( y12 + y23 ) * 0.5f;
-    float x234 = ( x23 + x34 ) * 0.5f,    y234 = ( y23 + y34 ) * 0.5f;
-    float x1234 = ( x123 + x234 ) * 0.5f, y1234 = ( y123 + y234 ) * 0.5f;
-    PathBezierToCasteljau( path, x1, y1,        x12, y12,    x123, y123,  x1234, y1234, tess_tol, level + 1 );
-    PathBezierToCasteljau( path, x1234, y1234,  x234, y234,  x34, y34,    x4, y4,       tess_tol, level + 1 );
+  const int path_size = path->Size;
+  path->resize( path_size + num_segments );
+  ImVec2 *out = path->Data + path_size;
+  ImVec2 p = p1;
+
+  for( int i = 0; i < num_segments - 1; i++ ) {
+    p.x += d1.x;
+    p.y += d1.y;
+    d1.x += d2.x;
+    d1.y += d2.y;
+    d2.x += d3.x;
+    d2.y += d3.y;
+    out[i] = p;
   }
+
+  out[num_segments - 1] = p4;
 }
 
 void ImDrawList::PathBezierCurveTo( const ImVec2 &p2, const ImVec2 &p3, const ImVec2 &p4, int num_segments ) {
   ImVec2 p1 = _Path.back();
 
   if( num_segments == 0 ) {
-    PathBezierToCasteljau( &_Path, p1.x, p1.y, p2.x, p2.y, p3.x, p3.y, p4.x, p4.y, _Data->CurveTessellationTol, 0 ); // Auto-tessellated
+    // Auto-tessellated, the segment count is worked out once from the control points so the path is only grown once
+    const ImVec2 diff1( p1.x - 2.0f * p2.x + p3.x, p1.y - 2.0f * p2.y + p3.y );
+    const ImVec2 diff2( p2.x - 2.0f * p3.x + p4.x, p2.y - 2.0f * p3.y + p4.y );
+    const float second_diff = ImSqrt( ImMax( ImLengthSqr( diff1 ), ImLengthSqr( diff2 ) ) );
+    PathBezierToForwardDifferences( &_Path, p1, p2, p3, p4, IM_DRAWLIST_BEZIER_AUTO_SEGMENT_CALC( second_diff, _Data->CurveTessellationTol ) );
   } else {
+    _Path.reserve( _Path.Size + num_segments );
+
     float t_step = 1.0f / ( float )num_segments;
 
     for( int i_step = 1; i_step <= num_segments; i_step++ ) {
@@ -1322,13 +1650,10 @@ void ImDrawList::AddCircle( const ImVec2 &center, float radius, ImU32 col, int n
     num_segments = ImClamp( num_segments, 3, IM_DRAWLIST_CIRCLE_AUTO_SEGMENT_MAX );
   }
 
-  // Because we are filling a closed shape we remove 1 from the count of segments/points
-  const float a_max = ( IM_PI * 2.0f ) * ( ( float )num_segments - 1.0f ) / ( float )num_segments;
-
   if( num_segments == 12 ) {
     PathArcToFast( center, radius - 0.5f, 0, 12 - 1 );
   } else {
-    PathArcTo( center, radius - 0.5f, 0.0f, a_max, num_segments - 1 );
+    _PathCircle( center, radius - 0.5f, num_segments );
   }
 
   PathStroke( col, true, thickness );
@@ -1354,13 +1679,10 @@ void ImDrawList::AddCircleFilled( const ImVec2 &center, float radius, ImU32 col,
     num_segments = ImClamp( num_segments, 3, IM_DRAWLIST_CIRCLE_AUTO_SEGMENT_MAX );
   }
 
-  // Because we are filling a closed shape we remove 1 from the count of segments/points
-  const float a_max = ( IM_PI * 2.0f ) * ( ( float )num_segments - 1.0f ) / ( float )num_segments;
-
   if( num_segments == 12 ) {
     PathArcToFast( center, radius, 0, 12 - 1 );
   } else {
-    PathArcTo( center, radius, 0.0f, a_max, num_segments - 1 );
+    _PathCircle( center, radius, num_segments );
   }
 
   PathFillConvex( col );
@@ -1372,9 +1694,7 @@ void ImDrawList::AddNgon( const ImVec2 &center, float radius, ImU32 col, int num
     return;
   }
 
-  // Because we are filling a closed shape we remove 1 from the count of segments/points
-  const float a_max = ( IM_PI * 2.0f ) * ( ( float )num_segments - 1.0f ) / ( float )num_segments;
-  PathArcTo( center, radius - 0.5f, 0.0f, a_max, num_segments - 1 );
+  _PathCircle( center, radius - 0.5f, num_segments );
   PathStroke( col, true, thickness );
 }
 
@@ -1384,9 +1704,7 @@ void ImDrawList::AddNgonFilled( const ImVec2 &center, float radius, ImU32 col, i
     return;
   }
 
-  // Because we are filling a closed shape we remove 1 from the count of segments/points
-  const float a_max = ( IM_PI * 2.0f ) * ( ( float )num_segments - 1.0f ) / ( float )num_segments;
-  PathArcTo( center, radius, 0.0f, a_max, num_segments - 1 );
+  _PathCircle( center, radius, num_segments );
   PathFillConvex( col );
 }
 
@@ -1401,6 +1719,69 @@ void ImDrawList::AddBezierCurve( const ImVec2 &p1, const ImVec2 &p2, const ImVec
   PathStroke( col, false, thickness );
 }
 
+// Translates the quads of a cached run, returns false when the run is partially clipped and needs ImFont::RenderText()
+static bool ImDrawListRenderTextRun( ImDrawList *draw_list, const ImDrawTextRunCache &cache, const ImDrawTextRun &run, const ImVec2 &pos, ImU32 col ) {
+  const ImVec4 &clip_rect = draw_list->_CmdHeader.ClipRect;
+  const float x = IM_FLOOR( pos.x + run.Font->DisplayOffset.x );
+  const float y = IM_FLOOR( pos.y + run.Font->DisplayOffset.y );
+
+  if( run.QuadCount == 0 || x + run.Bounds.x > clip_rect.z || x + run.Bounds.z < clip_rect.x || y + run.Bounds.y > clip_rect.w || y + run.Bounds.w < clip_rect.y ) {
+    return true;
+  }
+
+  if( x + run.Bounds.x < clip_rect.x || x + run.Bounds.z > clip_rect.z || y + run.Bounds.y < clip_rect.y || y + run.Bounds.w > clip_rect.w ) {
+    return false;
+  }
+
+  draw_list->PrimReserve( run.QuadCount * 6, run.QuadCount * 4 );
+
+  ImDrawVert *vtx_write = draw_list->_VtxWritePtr;
+  ImDrawIdx *idx_write = draw_list->_IdxWritePtr;
+  unsigned int vtx_current_idx = draw_list->_VtxCurrentIdx;
+  const ImVec4 *quad = cache.Quads.Data + run.QuadOffset;
+
+  for( int n = 0; n < run.QuadCount; n++, quad += 2 ) {
+    const float x1 = x + quad[0].x;
+    const float y1 = y + quad[0].y;
+    const float x2 = x + quad[0].z;
+    const float y2 = y + quad[0].w;
+    idx_write[0] = ( ImDrawIdx )( vtx_current_idx );
+    idx_write[1] = ( ImDrawIdx )( vtx_current_idx + 1 );
+    idx_write[2] = ( ImDrawIdx )( vtx_current_idx + 2 );
+    idx_write[3] = ( ImDrawIdx )( vtx_current_idx );
+    idx_write[4] = ( ImDrawIdx )( vtx_current_idx + 2 );
+    idx_write[5] = ( ImDrawIdx )( vtx_current_idx + 3 );
+    vtx_write[0].pos.x = x1;
+    vtx_write[0].pos.y = y1;
+    vtx_write[0].col = col;
+    vtx_write[0].uv.x = quad[1].x;
+    vtx_write[0].uv.y = quad[1].y;
+    vtx_write[1].pos.x = x2;
+    vtx_write[1].pos.y = y1;
+    vtx_write[1].col = col;
+    vtx_write[1].uv.x = quad[1].z;
+    vtx_write[1].uv.y = quad[1].y;
+    vtx_write[2].pos.x = x2;
+    vtx_write[2].pos.y = y2;
+    vtx_write[2].col = col;
+    vtx_write[2].uv.x = quad[1].z;
+    vtx_write[2].uv.y = quad[1].w;
+    vtx_write[3].pos.x = x1;
+    vtx_write[3].pos.y = y2;
+    vtx_write[3].col = col;
+    vtx_write[3].uv.x = quad[1].x;
+    vtx_write[3].uv.y = quad[1].w;
+    vtx_write += 4;
+    vtx_current_idx += 4;
+    idx_write += 6;
+  }
+
+  draw_list->_VtxWritePtr = vtx_write;
+  draw_list->_IdxWritePtr = idx_write;
+  draw_list->_VtxCurrentIdx = vtx_current_idx;
+  return true;
+}
+
 void ImDrawList::AddText( const ImFont *font, float font_size, const ImVec2 &pos, ImU32 col, const char *text_begin, const char *text_end, float wrap_width, const ImVec4 *cpu_fine_clip_rect ) {
   if( ( col & IM_COL32_A_MASK ) == 0 ) {
     return;
@@ -1425,6 +1806,15 @@ void ImDrawList::AddText( const ImFont *font, float font_size, const ImVec2 &pos
 
   IM_ASSERT( font->ContainerAtlas->TexID == _CmdHeader.TextureId ); // Use high-level ImGui::PushFont() or low-level ImDrawList::PushTextureId() to change font.
 
+  // Short runs are cached, the same text drawn again only has its quads translated
+  if( wrap_width <= 0.0f && cpu_fine_clip_rect == NULL && text_end - text_begin <= IM_DRAWLIST_TEXT_RUN_MAX_LENGTH ) {
+    const ImDrawTextRun *run = _Data->TextRuns.GetRun( font, font_size, text_begin, text_end );
+
+    if( run && ImDrawListRenderTextRun( this, _Data->TextRuns, *run, pos, col ) ) {
+      return;
+    }
+  }
+
   ImVec4 clip_rect = _CmdHeader.ClipRect;
 
   if( cpu_fine_clip_rect ) {
@@ -2675,6 +3065,358 @@ void ImFontAtlasBuildFinish( ImFontAtlas *atlas ) {
   }
 }
 
+// Baked atlas blobs are little endian 32-bit values, the alpha8 pixels are stored as (zero count, literal count, literals) runs.
+// They are only meant to be loaded by the same version and configuration of Dear ImGui that saved them.
+static const ImU32 FONT_ATLAS_BAKED_MAGIC = 0x42414D49; // "IMAB"
+static const ImU32 FONT_ATLAS_BAKED_VERSION = 1;
+
+static void ImFontAtlasBakedWriteU32( ImVector<unsigned char> *out, ImU32 v ) {
+  out->push_back( ( unsigned char )( v ) );
+  out->push_back( ( unsigned char )( v >> 8 ) );
+  out->push_back( ( unsigned char )( v >> 16 ) );
+  out->push_back( ( unsigned char )( v >> 24 ) );
+}
+
+static void ImFontAtlasBakedWriteFloat( ImVector<unsigned char> *out, float f ) {
+  ImU32 v;
+  memcpy( &v, &f, sizeof( v ) );
+  ImFontAtlasBakedWriteU32( out, v );
+}
+
+struct ImFontAtlasBakedReader {
+  const unsigned char *Data;
+  int                  Size;
+  int                  Pos;
+  bool                 Failed;
+
+  ImFontAtlasBakedReader( const void *data, int size ) {
+    Data = ( const unsigned char * )data;
+    Size = size;
+    Pos = 0;
+    Failed = false;
+  }
+  ImU32 ReadU32() {
+    if( Failed || Size - Pos < 4 ) {
+      Failed = true;
+      return 0;
+    }
+
+    const unsigned char *p = Data + Pos;
+    Pos += 4;
+    return ( ImU32 )p[0] | ( ( ImU32 )p[1] << 8 ) | ( ( ImU32 )p[2] << 16 ) | ( ( ImU32 )p[3] << 24 );
+  }
+  float ReadFloat() {
+    ImU32 v = ReadU32();
+    float f;
+    memcpy( &f, &v, sizeof( f ) );
+    return f;
+  }
+  const unsigned char *ReadBytes( ImU32 count ) {
+    if( Failed || ( ImU32 )( Size - Pos ) < count ) {
+      Failed = true;
+      return NULL;
+    }
+
+    const unsigned char *p = Data + Pos;
+    Pos += ( int )count;
+    return p;
+  }
+};
+
+bool ImFontAtlasBuildSaveBaked( ImFontAtlas *atlas, ImVector<unsigned char> *out_blob ) {
+  if( atlas->TexPixelsAlpha8 == NULL ) {
+    return false;
+  }
+
+  out_blob->resize( 0 );
+  ImFontAtlasBakedWriteU32( out_blob, FONT_ATLAS_BAKED_MAGIC );
+  ImFontAtlasBakedWriteU32( out_blob, FONT_ATLAS_BAKED_VERSION );
+  ImFontAtlasBakedWriteU32( out_blob, IMGUI_VERSION_NUM );
+  ImFontAtlasBakedWriteU32( out_blob, ( ImU32 )sizeof( ImWchar ) );
+  ImFontAtlasBakedWriteU32( out_blob, IM_ARRAYSIZE( atlas->TexUvLines ) );
+
+  // Texture
+  ImFontAtlasBakedWriteU32( out_blob, ( ImU32 )atlas->TexWidth );
+  ImFontAtlasBakedWriteU32( out_blob, ( ImU32 )atlas->TexHeight );
+  ImFontAtlasBakedWriteFloat( out_blob, atlas->TexUvScale.x );
+  ImFontAtlasBakedWriteFloat( out_blob, atlas->TexUvScale.y );
+  ImFontAtlasBakedWriteFloat( out_blob, atlas->TexUvWhitePixel.x );
+  ImFontAtlasBakedWriteFloat( out_blob, atlas->TexUvWhitePixel.y );
+
+  for( int n = 0; n < IM_ARRAYSIZE( atlas->TexUvLines ); n++ ) {
+    ImFontAtlasBakedWriteFloat( out_blob, atlas->TexUvLines[n].x );
+    ImFontAtlasBakedWriteFloat( out_blob, atlas->TexUvLines[n].y );
+    ImFontAtlasBakedWriteFloat( out_blob, atlas->TexUvLines[n].z );
+    ImFontAtlasBakedWriteFloat( out_blob, atlas->TexUvLines[n].w );
+  }
+
+  // Fonts
+  ImFontAtlasBakedWriteU32( out_blob, ( ImU32 )atlas->Fonts.Size );
+
+  for( int font_n = 0; font_n < atlas->Fonts.Size; font_n++ ) {
+    const ImFont *font = atlas->Fonts[font_n];
+    const char *name = font->ConfigData ? font->ConfigData->Name : "";
+    const ImU32 name_len = ( ImU32 )strlen( name );
+    ImFontAtlasBakedWriteU32( out_blob, name_len );
+
+    for( ImU32 n = 0; n < name_len; n++ ) {
+      out_blob->push_back( ( unsigned char )name[n] );
+    }
+
+    ImFontAtlasBakedWriteFloat( out_blob, font->ConfigData ? font->ConfigData->SizePixels : font->FontSize );
+    ImFontAtlasBakedWriteFloat( out_blob, font->FontSize );
+    ImFontAtlasBakedWriteFloat( out_blob, font->Scale );
+    ImFontAtlasBakedWriteFloat( out_blob, font->Ascent );
+    ImFontAtlasBakedWriteFloat( out_blob, font->Descent );
+    ImFontAtlasBakedWriteFloat( out_blob, font->DisplayOffset.x );
+    ImFontAtlasBakedWriteFloat( out_blob, font->DisplayOffset.y );
+    ImFontAtlasBakedWriteU32( out_blob, font->FallbackChar );
+    ImFontAtlasBakedWriteU32( out_blob, font->EllipsisChar );
+    ImFontAtlasBakedWriteU32( out_blob, ( ImU32 )font->MetricsTotalSurface );
+    ImFontAtlasBakedWriteU32( out_blob, ( ImU32 )font->Glyphs.Size );
+
+    for( int glyph_n = 0; glyph_n < font->Glyphs.Size; glyph_n++ ) {
+      const ImFontGlyph &glyph = font->Glyphs[glyph_n];
+      ImFontAtlasBakedWriteU32( out_blob, glyph.Codepoint | ( ( ImU32 )glyph.Visible << 31 ) );
+      ImFontAtlasBakedWriteFloat( out_blob, glyph.AdvanceX );
+      ImFontAtlasBakedWriteFloat( out_blob, glyph.X0 );
+      ImFontAtlasBakedWriteFloat( out_blob, glyph.Y0 );
+      ImFontAtlasBakedWriteFloat( out_blob, glyph.X1 );
+      ImFontAtlasBakedWriteFloat( out_blob, glyph.Y1 );
+      ImFontAtlasBakedWriteFloat( out_blob, glyph.U0 );
+      ImFontAtlasBakedWriteFloat( out_blob, glyph.V0 );
+      ImFontAtlasBakedWriteFloat( out_blob, glyph.U1 );
+      ImFontAtlasBakedWriteFloat( out_blob, glyph.V1 );
+    }
+  }
+
+  // Custom rectangles, fonts are referred to by index
+  ImFontAtlasBakedWriteU32( out_blob, ( ImU32 )atlas->PackIdMouseCursors );
+  ImFontAtlasBakedWriteU32( out_blob, ( ImU32 )atlas->PackIdLines );
+  ImFontAtlasBakedWriteU32( out_blob, ( ImU32 )atlas->CustomRects.Size );
+
+  for( int n = 0; n < atlas->CustomRects.Size; n++ ) {
+    const ImFontAtlasCustomRect &r = atlas->CustomRects[n];
+    ImFontAtlasBakedWriteU32( out_blob, r.Width | ( ( ImU32 )r.Height << 16 ) );
+    ImFontAtlasBakedWriteU32( out_blob, r.X | ( ( ImU32 )r.Y << 16 ) );
+    ImFontAtlasBakedWriteU32( out_blob, r.GlyphID );
+    ImFontAtlasBakedWriteFloat( out_blob, r.GlyphAdvanceX );
+    ImFontAtlasBakedWriteFloat( out_blob, r.GlyphOffset.x );
+    ImFontAtlasBakedWriteFloat( out_blob, r.GlyphOffset.y );
+    ImFontAtlasBakedWriteU32( out_blob, ( ImU32 )( r.Font ? atlas->Fonts.index_from_ptr( atlas->Fonts.find( r.Font ) ) : -1 ) );
+  }
+
+  // Pixels
+  const unsigned char *pixels = atlas->TexPixelsAlpha8;
+  const int pixels_count = atlas->TexWidth * atlas->TexHeight;
+
+  for( int n = 0; n < pixels_count; ) {
+    int zeros_end = n;
+
+    while( zeros_end < pixels_count && pixels[zeros_end] == 0 ) {
+      zeros_end++;
+    }
+
+    // Literals stop at the next run of zeros worth encoding on its own
+    int literals_end = zeros_end;
+    int zeros = 0;
+
+    while( literals_end < pixels_count && zeros < 8 ) {
+      zeros = pixels[literals_end++] == 0 ? zeros + 1 : 0;
+    }
+
+    if( zeros >= 8 ) {
+      literals_end -= zeros;
+    }
+
+    ImFontAtlasBakedWriteU32( out_blob, ( ImU32 )( zeros_end - n ) );
+    ImFontAtlasBakedWriteU32( out_blob, ( ImU32 )( literals_end - zeros_end ) );
+
+    for( int i = zeros_end; i < literals_end; i++ ) {
+      out_blob->push_back( pixels[i] );
+    }
+
+    n = literals_end;
+  }
+
+  return true;
+}
+
+static bool ImFontAtlasBuildLoadBakedFonts( ImFontAtlas *atlas, ImFontAtlasBakedReader &in ) {
+  if( in.ReadU32() != FONT_ATLAS_BAKED_MAGIC || in.ReadU32() != FONT_ATLAS_BAKED_VERSION || in.ReadU32() != IMGUI_VERSION_NUM || in.ReadU32() != sizeof( ImWchar ) || in.ReadU32() != IM_ARRAYSIZE( atlas->TexUvLines ) ) {
+    return false;
+  }
+
+  // Texture
+  atlas->TexWidth = ( int )in.ReadU32();
+  atlas->TexHeight = ( int )in.ReadU32();
+  atlas->TexUvScale.x = in.ReadFloat();
+  atlas->TexUvScale.y = in.ReadFloat();
+  atlas->TexUvWhitePixel.x = in.ReadFloat();
+  atlas->TexUvWhitePixel.y = in.ReadFloat();
+
+  for( int n = 0; n < IM_ARRAYSIZE( atlas->TexUvLines ); n++ ) {
+    atlas->TexUvLines[n].x = in.ReadFloat();
+    atlas->TexUvLines[n].y = in.ReadFloat();
+    atlas->TexUvLines[n].z = in.ReadFloat();
+    atlas->TexUvLines[n].w = in.ReadFloat();
+  }
+
+  if( in.Failed || atlas->TexWidth <= 0 || atlas->TexHeight <= 0 || atlas->TexWidth > 0x4000 || atlas->TexHeight > 0x4000 ) {
+    return false;
+  }
+
+  // Fonts, the configurations are created first as the fonts point into their array
+  const ImU32 fonts_count = in.ReadU32();
+
+  if( in.Failed || fonts_count > ( ImU32 )( in.Size - in.Pos ) ) {
+    return false;
+  }
+
+  for( ImU32 font_n = 0; font_n < fonts_count; font_n++ ) {
+    atlas->Fonts.push_back( IM_NEW( ImFont ) );
+    atlas->ConfigData.push_back( ImFontConfig() );
+  }
+
+  for( ImU32 font_n = 0; font_n < fonts_count; font_n++ ) {
+    ImFont *font = atlas->Fonts[font_n];
+    ImFontConfig &cfg = atlas->ConfigData[font_n];
+    const ImU32 name_len = in.ReadU32();
+    const unsigned char *name = in.ReadBytes( name_len );
+
+    if( name == NULL || name_len >= IM_ARRAYSIZE( cfg.Name ) ) {
+      return false;
+    }
+
+    memcpy( cfg.Name, name, name_len );
+    cfg.Name[name_len] = 0;
+    cfg.FontData = NULL;
+    cfg.FontDataOwnedByAtlas = false;
+    cfg.SizePixels = in.ReadFloat();
+    cfg.DstFont = font;
+
+    font->ContainerAtlas = atlas;
+    font->ConfigData = &cfg;
+    font->ConfigDataCount = 1;
+    font->FontSize = in.ReadFloat();
+    font->Scale = in.ReadFloat();
+    font->Ascent = in.ReadFloat();
+    font->Descent = in.ReadFloat();
+    font->DisplayOffset.x = in.ReadFloat();
+    font->DisplayOffset.y = in.ReadFloat();
+    font->FallbackChar = ( ImWchar )in.ReadU32();
+    font->EllipsisChar = ( ImWchar )in.ReadU32();
+    font->MetricsTotalSurface = ( int )in.ReadU32();
+
+    const ImU32 glyphs_count = in.ReadU32();
+
+    if( in.Failed || glyphs_count >= 0xFFFF || glyphs_count > ( ImU32 )( in.Size - in.Pos ) / 40 ) {
+      return false;
+    }
+
+    font->Glyphs.resize( ( int )glyphs_count );
+
+    for( ImU32 glyph_n = 0; glyph_n < glyphs_count; glyph_n++ ) {
+      ImFontGlyph &glyph = font->Glyphs[glyph_n];
+      const ImU32 codepoint = in.ReadU32();
+
+      if( ( codepoint & 0x7FFFFFFF ) > IM_UNICODE_CODEPOINT_MAX ) {
+        return false;
+      }
+
+      glyph.Codepoint = codepoint & 0x7FFFFFFF;
+      glyph.Visible = codepoint >> 31;
+      glyph.AdvanceX = in.ReadFloat();
+      glyph.X0 = in.ReadFloat();
+      glyph.Y0 = in.ReadFloat();
+      glyph.X1 = in.ReadFloat();
+      glyph.Y1 = in.ReadFloat();
+      glyph.U0 = in.ReadFloat();
+      glyph.V0 = in.ReadFloat();
+      glyph.U1 = in.ReadFloat();
+      glyph.V1 = in.ReadFloat();
+    }
+
+    font->BuildLookupTable();
+  }
+
+  // Custom rectangles
+  atlas->PackIdMouseCursors = ( int )in.ReadU32();
+  atlas->PackIdLines = ( int )in.ReadU32();
+  const ImU32 rects_count = in.ReadU32();
+
+  if( in.Failed || rects_count > ( ImU32 )( in.Size - in.Pos ) / 28 ) {
+    return false;
+  }
+
+  for( ImU32 n = 0; n < rects_count; n++ ) {
+    ImFontAtlasCustomRect r;
+    const ImU32 size = in.ReadU32();
+    const ImU32 pos = in.ReadU32();
+    r.Width = ( unsigned short )( size & 0xFFFF );
+    r.Height = ( unsigned short )( size >> 16 );
+    r.X = ( unsigned short )( pos & 0xFFFF );
+    r.Y = ( unsigned short )( pos >> 16 );
+    r.GlyphID = in.ReadU32();
+    r.GlyphAdvanceX = in.ReadFloat();
+    r.GlyphOffset.x = in.ReadFloat();
+    r.GlyphOffset.y = in.ReadFloat();
+    const int font_n = ( int )in.ReadU32();
+
+    if( font_n >= ( int )fonts_count ) {
+      return false;
+    }
+
+    r.Font = font_n >= 0 ? atlas->Fonts[font_n] : NULL;
+    atlas->CustomRects.push_back( r );
+  }
+
+  if( atlas->PackIdMouseCursors < -1 || atlas->PackIdMouseCursors >= atlas->CustomRects.Size || atlas->PackIdLines < -1 || atlas->PackIdLines >= atlas->CustomRects.Size ) {
+    return false;
+  }
+
+  // Pixels, expanded straight to the RGBA32 layout of GetTexDataAsRGBA32()
+  const int pixels_count = atlas->TexWidth * atlas->TexHeight;
+  atlas->TexPixelsRGBA32 = ( unsigned int * )IM_ALLOC( ( size_t )pixels_count * 4 );
+  unsigned int *dst = atlas->TexPixelsRGBA32;
+
+  for( int n = 0; n < pixels_count; ) {
+    const ImU32 zeros = in.ReadU32();
+    const ImU32 literals_count = in.ReadU32();
+    const unsigned char *literals = in.ReadBytes( literals_count );
+
+    if( literals == NULL || zeros + literals_count == 0 || zeros > ( ImU32 )( pixels_count - n ) || literals_count > ( ImU32 )( pixels_count - n ) - zeros ) {
+      return false;
+    }
+
+    for( ImU32 i = 0; i < zeros; i++ ) {
+      *dst++ = IM_COL32( 255, 255, 255, 0 );
+    }
+
+    for( ImU32 i = 0; i < literals_count; i++ ) {
+      *dst++ = IM_COL32( 255, 255, 255, ( unsigned int )literals[i] );
+    }
+
+    n += ( int )( zeros + literals_count );
+  }
+
+  return in.Pos == in.Size;
+}
+
+bool ImFontAtlasBuildLoadBaked( ImFontAtlas *atlas, const void *blob, int blob_size ) {
+  IM_ASSERT( !atlas->Locked && "Cannot modify a locked ImFontAtlas between NewFrame() and EndFrame/Render()!" );
+  atlas->Clear();
+
+  ImFontAtlasBakedReader in( blob, blob_size );
+
+  if( !ImFontAtlasBuildLoadBakedFonts( atlas, in ) ) {
+    atlas->Clear();
+    return false;
+  }
+
+  return true;
+}
+
 // Retrieve list of range (2 int per range, values are inclusive)
 const ImWchar   *ImFontAtlas::GetGlyphRangesDefault() {
   static const ImWchar ranges[] = {
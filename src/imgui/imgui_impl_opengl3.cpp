@@ -5,7 +5,7 @@
 
 // Implemented features:
 //  [X] Renderer: User texture binding. Use 'GLuint' OpenGL texture identifier as void*/ImTextureID. Read the FAQ about ImTextureID!
-//  [x] Renderer: Desktop GL only: Support for large meshes (64k+ vertices) with 16-bit indices.
+//  [x] Renderer: Support for large meshes (64k+ vertices) with 16-bit indices. GL ES / WebGL emulate the base vertex by re-pointing the vertex attributes.
 
 // You can copy and use unmodified imgui_impl_* files in your project. See main.cpp for an example of using this.
 // If you are new to dear imgui, read examples/README.txt and read the documentation at the top of imgui.cpp.
@@ -75,6 +75,7 @@
 #include "imgui.h"
 #include "imgui_impl_opengl3.h"
 #include <stdio.h>
+#include <math.h>
 #if defined(_MSC_VER) && _MSC_VER <= 1500 // MSVC 2008 or earlier
 #include <stddef.h>     // intptr_t
 #else
@@ -138,6 +139,36 @@ static GLuint       g_ShaderHandle = 0, g_VertHandle = 0, g_FragHandle = 0;
 static GLint        g_AttribLocationTex = 0, g_AttribLocationProjMtx = 0;                                // Uniforms location
 static GLuint       g_AttribLocationVtxPos = 0, g_AttribLocationVtxUV = 0, g_AttribLocationVtxColor = 0; // Vertex attributes location
 static unsigned int g_VboHandle = 0, g_ElementsHandle = 0;
+static GLsizeiptr   g_VboSize = 0, g_ElementsSize = 0;                                                   // Allocated bytes, only grows
+static ImVector<ImDrawVert> g_VtxStaging;                                                                // Every draw list packed for a single upload
+static ImVector<ImDrawIdx>  g_IdxStaging;
+static bool         g_ExclusiveContext = false;                                                          // Set by ImGui_ImplOpenGL3_SetExclusiveContext()
+static GLuint       g_VaoHandle = 0;                                                                     // Kept across frames with an exclusive context
+static bool         g_PremultipliedTarget = false;                                                       // Set by ImGui_ImplOpenGL3_SetPremultipliedTarget()
+static bool         g_CompactVertices = false;                                                           // Set by ImGui_ImplOpenGL3_SetCompactVertices()
+
+// Vertex uploaded instead of ImDrawVert with compact vertices: 12 bytes instead of 20. Positions are
+// relative to DisplayPos in 1/8 pixel, so they reach 4096 pixels, and UVs are normalized to 16 bits.
+struct ImGui_ImplOpenGL3_CompactVert {
+  ImS16        pos[2];
+  ImU16        uv[2];
+  ImU32        col;
+};
+static const float  g_CompactPosScale = 8.0f;
+static ImVector<ImGui_ImplOpenGL3_CompactVert> g_CompactStaging;                                        // Every draw list packed for a single upload
+
+// Shadow copy of the state we set for rendering. Within a frame it skips redundant texture and scissor changes,
+// with an exclusive context it also lives across frames so the render state is only set up once.
+static struct {
+  bool         Valid;          // Render state is set up, exclusive context only
+  bool         Bound;          // Texture and ScissorBox hold what GL has
+  GLuint       Texture;
+  GLint        ScissorBox[4];
+  ImVec2       DisplayPos;     // Projection matrix uploaded for these
+  ImVec2       DisplaySize;
+  bool         Compact;        // Layout of the uploaded vertices, the projection and attributes are set up for
+  unsigned int VtxOffset;      // Vertex the attributes point at
+} g_State;
 
 // Functions
 bool    ImGui_ImplOpenGL3_Init( const char *glsl_version ) {
@@ -154,13 +185,9 @@ bool    ImGui_ImplOpenGL3_Init( const char *glsl_version ) {
   // Setup back-end capabilities flags
   ImGuiIO &io = ImGui::GetIO();
   io.BackendRendererName = "imgui_impl_opengl3";
-#if IMGUI_IMPL_OPENGL_MAY_HAVE_VTX_OFFSET
-
-  if( g_GlVersion >= 320 ) {
-    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;  // We can honor the ImDrawCmd::VtxOffset field, allowing for large meshes.
-  }
-
-#endif
+  // We can honor the ImDrawCmd::VtxOffset field, allowing for large meshes. Without glDrawElementsBaseVertex()
+  // (GL ES, WebGL, GL < 3.2) the vertex attributes are pointed at the command's first vertex instead.
+  io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
 
   // Store GLSL version string so we can refer to it later in case we recreate shaders.
   // Note: GLSL version is NOT the same as GL version. Leave this to NULL if unsure.
@@ -237,18 +264,135 @@ void    ImGui_ImplOpenGL3_NewFrame() {
   }
 }
 
-static void ImGui_ImplOpenGL3_SetupRenderState( ImDrawData *draw_data, int fb_width, int fb_height, GLuint vertex_array_object ) {
-  // Setup render state: alpha-blending enabled, no face culling, no depth testing, scissor enabled, polygon fill
-  glEnable( GL_BLEND );
-  glBlendEquation( GL_FUNC_ADD );
-  glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
-  glDisable( GL_CULL_FACE );
-  glDisable( GL_DEPTH_TEST );
-  glEnable( GL_SCISSOR_TEST );
-#ifdef GL_POLYGON_MODE
-  glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
-#endif
+void    ImGui_ImplOpenGL3_SetExclusiveContext( bool exclusive ) {
+  g_ExclusiveContext = exclusive;
+  g_State.Valid = false;
+}
+
+void    ImGui_ImplOpenGL3_InvalidateState() {
+  g_State.Valid = false;
+  g_State.Bound = false;
+}
+
+void    ImGui_ImplOpenGL3_SetPremultipliedTarget( bool premultiplied ) {
+  g_PremultipliedTarget = premultiplied;
+  g_State.Valid = false;
+}
+
+void    ImGui_ImplOpenGL3_SetCompactVertices( bool compact ) {
+  g_CompactVertices = compact;
+}
+
+// Point the vertex attributes at the vertex buffer, starting at vertex 'vtx_offset'.
+// This is how ImDrawCmd::VtxOffset is honored when glDrawElementsBaseVertex() is not available.
+static void ImGui_ImplOpenGL3_SetupVertexAttribs( unsigned int vtx_offset ) {
+  if( g_State.Compact ) {
+    const size_t base = vtx_offset * sizeof( ImGui_ImplOpenGL3_CompactVert );
+    glVertexAttribPointer( g_AttribLocationVtxPos,   2, GL_SHORT,          GL_FALSE, sizeof( ImGui_ImplOpenGL3_CompactVert ), ( GLvoid * )( base + IM_OFFSETOF( ImGui_ImplOpenGL3_CompactVert, pos ) ) );
+    glVertexAttribPointer( g_AttribLocationVtxUV,    2, GL_UNSIGNED_SHORT, GL_TRUE,  sizeof( ImGui_ImplOpenGL3_CompactVert ), ( GLvoid * )( base + IM_OFFSETOF( ImGui_ImplOpenGL3_CompactVert, uv ) ) );
+    glVertexAttribPointer( g_AttribLocationVtxColor, 4, GL_UNSIGNED_BYTE,  GL_TRUE,  sizeof( ImGui_ImplOpenGL3_CompactVert ), ( GLvoid * )( base + IM_OFFSETOF( ImGui_ImplOpenGL3_CompactVert, col ) ) );
+    return;
+  }
+
+  const size_t base = vtx_offset * sizeof( ImDrawVert );
+  glVertexAttribPointer( g_AttribLocationVtxPos,   2, GL_FLOAT,         GL_FALSE, sizeof( ImDrawVert ), ( GLvoid * )( base + IM_OFFSETOF( ImDrawVert, pos ) ) );
+  glVertexAttribPointer( g_AttribLocationVtxUV,    2, GL_FLOAT,         GL_FALSE, sizeof( ImDrawVert ), ( GLvoid * )( base + IM_OFFSETOF( ImDrawVert, uv ) ) );
+  glVertexAttribPointer( g_AttribLocationVtxColor, 4, GL_UNSIGNED_BYTE, GL_TRUE,  sizeof( ImDrawVert ), ( GLvoid * )( base + IM_OFFSETOF( ImDrawVert, col ) ) );
+}
+
+// Upload the whole frame with a single glBufferSubData() per buffer. The buffers are only reallocated when
+// they grow, so the number of uploads doesn't depend on the number of windows and the allocation is reused.
+static void ImGui_ImplOpenGL3_UploadBuffer( GLenum target, GLsizeiptr &allocated, const void *data, GLsizeiptr size ) {
+  if( size > allocated ) {
+    allocated = size + size / 2;
+    glBufferData( target, allocated, NULL, GL_STREAM_DRAW );
+  }
+
+  glBufferSubData( target, 0, size, data );
+}
+
+// Pack every vertex of the frame into g_CompactStaging, fails when a position or UV doesn't fit in 16 bits
+static bool ImGui_ImplOpenGL3_PackCompact( ImDrawData *draw_data ) {
+  const float pos_max = 32767.0f / g_CompactPosScale;
+  const float pos_min = -32768.0f / g_CompactPosScale;
+  g_CompactStaging.resize( draw_data->TotalVtxCount );
+  ImGui_ImplOpenGL3_CompactVert *vtx_dst = g_CompactStaging.Data;
+
+  for( int n = 0; n < draw_data->CmdListsCount; n++ ) {
+    const ImDrawList *cmd_list = draw_data->CmdLists[n];
+
+    for( const ImDrawVert &vtx : cmd_list->VtxBuffer ) {
+      const float x = vtx.pos.x - draw_data->DisplayPos.x;
+      const float y = vtx.pos.y - draw_data->DisplayPos.y;
+
+      if( !( x >= pos_min && x <= pos_max && y >= pos_min && y <= pos_max &&
+             vtx.uv.x >= 0.0f && vtx.uv.x <= 1.0f && vtx.uv.y >= 0.0f && vtx.uv.y <= 1.0f ) ) {
+        return false;
+      }
+
+      vtx_dst->pos[0] = ( ImS16 )floorf( x * g_CompactPosScale + 0.5f );
+      vtx_dst->pos[1] = ( ImS16 )floorf( y * g_CompactPosScale + 0.5f );
+      vtx_dst->uv[0] = ( ImU16 )( vtx.uv.x * 65535.0f + 0.5f );
+      vtx_dst->uv[1] = ( ImU16 )( vtx.uv.y * 65535.0f + 0.5f );
+      vtx_dst->col = vtx.col;
+      vtx_dst++;
+    }
+  }
+
+  return true;
+}
+
+static void ImGui_ImplOpenGL3_UploadDrawData( ImDrawData *draw_data ) {
+  const void *vtx_data;
+  const ImDrawIdx *idx_data;
+  size_t vtx_size;
+
+  if( g_State.Compact ) {
+    // Already packed by ImGui_ImplOpenGL3_PackCompact()
+    vtx_data = g_CompactStaging.Data;
+    vtx_size = sizeof( ImGui_ImplOpenGL3_CompactVert );
+  } else {
+    vtx_data = NULL;
+    vtx_size = sizeof( ImDrawVert );
+  }
+
+  if( draw_data->CmdListsCount == 1 ) {
+    if( !g_State.Compact ) {
+      vtx_data = draw_data->CmdLists[0]->VtxBuffer.Data;
+    }
+
+    idx_data = draw_data->CmdLists[0]->IdxBuffer.Data;
+  } else {
+    if( !g_State.Compact ) {
+      g_VtxStaging.resize( draw_data->TotalVtxCount );
+      vtx_data = g_VtxStaging.Data;
+    }
 
+    g_IdxStaging.resize( draw_data->TotalIdxCount );
+    ImDrawVert *vtx_dst = g_VtxStaging.Data;
+    ImDrawIdx *idx_dst = g_IdxStaging.Data;
+
+    for( int n = 0; n < draw_data->CmdListsCount; n++ ) {
+      const ImDrawList *cmd_list = draw_data->CmdLists[n];
+
+      if( !g_State.Compact ) {
+        memcpy( vtx_dst, cmd_list->VtxBuffer.Data, cmd_list->VtxBuffer.Size * sizeof( ImDrawVert ) );
+        vtx_dst += cmd_list->VtxBuffer.Size;
+      }
+
+      memcpy( idx_dst, cmd_list->IdxBuffer.Data, cmd_list->IdxBuffer.Size * sizeof( ImDrawIdx ) );
+      idx_dst += cmd_list->IdxBuffer.Size;
+    }
+
+    idx_data = g_IdxStaging.Data;
+  }
+
+  ImGui_ImplOpenGL3_UploadBuffer( GL_ARRAY_BUFFER, g_VboSize, vtx_data, ( GLsizeiptr )draw_data->TotalVtxCount * ( int )vtx_size );
+  ImGui_ImplOpenGL3_UploadBuffer( GL_ELEMENT_ARRAY_BUFFER, g_ElementsSize, idx_data, ( GLsizeiptr )draw_data->TotalIdxCount * ( int )sizeof( ImDrawIdx ) );
+}
+
+// Upload the projection matrix to our program, which must be in use
+static void ImGui_ImplOpenGL3_SetupProjection( ImDrawData *draw_data ) {
   // Support for GL 4.5 rarely used glClipControl(GL_UPPER_LEFT)
   bool clip_origin_lower_left = true;
 #if defined(GL_CLIP_ORIGIN) && !defined(__APPLE__)
@@ -261,14 +405,21 @@ static void ImGui_ImplOpenGL3_SetupRenderState( ImDrawData *draw_data, int fb_wi
 
 #endif
 
-  // Setup viewport, orthographic projection matrix
+  // Setup orthographic projection matrix
   // Our visible imgui space lies from draw_data->DisplayPos (top left) to draw_data->DisplayPos+data_data->DisplaySize (bottom right). DisplayPos is (0,0) for single viewport apps.
-  glViewport( 0, 0, ( GLsizei )fb_width, ( GLsizei )fb_height );
   float L = draw_data->DisplayPos.x;
   float R = draw_data->DisplayPos.x + draw_data->DisplaySize.x;
   float T = draw_data->DisplayPos.y;
   float B = draw_data->DisplayPos.y + draw_data->DisplaySize.y;
 
+  if( g_State.Compact ) {
+    // Compact positions are fixed point relative to DisplayPos
+    L = 0.0f;
+    R = draw_data->DisplaySize.x * g_CompactPosScale;
+    T = 0.0f;
+    B = draw_data->DisplaySize.y * g_CompactPosScale;
+  }
+
   if( !clip_origin_lower_left ) {
     float tmp = T;  // Swap top and bottom if origin is upper left
     T = B;
@@ -281,9 +432,33 @@ static void ImGui_ImplOpenGL3_SetupRenderState( ImDrawData *draw_data, int fb_wi
     { 0.0f,         0.0f,        -1.0f,   0.0f },
     { ( R + L ) / ( L - R ), ( T + B ) / ( B - T ),  0.0f,   1.0f },
   };
+  glUniformMatrix4fv( g_AttribLocationProjMtx, 1, GL_FALSE, &ortho_projection[0][0] );
+  g_State.DisplayPos = draw_data->DisplayPos;
+  g_State.DisplaySize = draw_data->DisplaySize;
+}
+
+static void ImGui_ImplOpenGL3_SetupRenderState( ImDrawData *draw_data, int fb_width, int fb_height, GLuint vertex_array_object ) {
+  // Setup render state: alpha-blending enabled, no face culling, no depth testing, scissor enabled, polygon fill
+  glEnable( GL_BLEND );
+  glBlendEquation( GL_FUNC_ADD );
+
+  if( g_PremultipliedTarget ) {
+    glBlendFuncSeparate( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA );
+  } else {
+    glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+  }
+
+  glDisable( GL_CULL_FACE );
+  glDisable( GL_DEPTH_TEST );
+  glEnable( GL_SCISSOR_TEST );
+#ifdef GL_POLYGON_MODE
+  glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
+#endif
+
+  glViewport( 0, 0, ( GLsizei )fb_width, ( GLsizei )fb_height );
   glUseProgram( g_ShaderHandle );
   glUniform1i( g_AttribLocationTex, 0 );
-  glUniformMatrix4fv( g_AttribLocationProjMtx, 1, GL_FALSE, &ortho_projection[0][0] );
+  ImGui_ImplOpenGL3_SetupProjection( draw_data );
 #ifdef GL_SAMPLER_BINDING
   glBindSampler( 0, 0 ); // We use combined texture/sampler state. Applications using GL 3.3 may set that otherwise.
 #endif
@@ -299,9 +474,105 @@ static void ImGui_ImplOpenGL3_SetupRenderState( ImDrawData *draw_data, int fb_wi
   glEnableVertexAttribArray( g_AttribLocationVtxPos );
   glEnableVertexAttribArray( g_AttribLocationVtxUV );
   glEnableVertexAttribArray( g_AttribLocationVtxColor );
-  glVertexAttribPointer( g_AttribLocationVtxPos,   2, GL_FLOAT,         GL_FALSE, sizeof( ImDrawVert ), ( GLvoid * )IM_OFFSETOF( ImDrawVert, pos ) );
-  glVertexAttribPointer( g_AttribLocationVtxUV,    2, GL_FLOAT,         GL_FALSE, sizeof( ImDrawVert ), ( GLvoid * )IM_OFFSETOF( ImDrawVert, uv ) );
-  glVertexAttribPointer( g_AttribLocationVtxColor, 4, GL_UNSIGNED_BYTE, GL_TRUE,  sizeof( ImDrawVert ), ( GLvoid * )IM_OFFSETOF( ImDrawVert, col ) );
+  ImGui_ImplOpenGL3_SetupVertexAttribs( 0 );
+  g_State.VtxOffset = 0;
+  g_State.Bound = false;
+}
+
+// GL state backed up before rendering and restored after, unless the context is exclusive
+struct ImGui_ImplOpenGL3_SavedState {
+  GLenum    ActiveTexture;
+  GLuint    Program;
+  GLuint    Texture;
+#ifdef GL_SAMPLER_BINDING
+  GLuint    Sampler;
+#endif
+  GLuint    ArrayBuffer;
+#ifndef IMGUI_IMPL_OPENGL_ES2
+  GLuint    VertexArrayObject;
+#endif
+#ifdef GL_POLYGON_MODE
+  GLint     PolygonMode[2];
+#endif
+  GLint     Viewport[4];
+  GLint     ScissorBox[4];
+  GLenum    BlendSrcRgb, BlendDstRgb, BlendSrcAlpha, BlendDstAlpha;
+  GLenum    BlendEquationRgb, BlendEquationAlpha;
+  GLboolean EnableBlend, EnableCullFace, EnableDepthTest, EnableScissorTest;
+};
+
+static void ImGui_ImplOpenGL3_BackupState( ImGui_ImplOpenGL3_SavedState &state ) {
+  glGetIntegerv( GL_ACTIVE_TEXTURE, ( GLint * )&state.ActiveTexture );
+  glActiveTexture( GL_TEXTURE0 );
+  glGetIntegerv( GL_CURRENT_PROGRAM, ( GLint * )&state.Program );
+  glGetIntegerv( GL_TEXTURE_BINDING_2D, ( GLint * )&state.Texture );
+#ifdef GL_SAMPLER_BINDING
+  glGetIntegerv( GL_SAMPLER_BINDING, ( GLint * )&state.Sampler );
+#endif
+  glGetIntegerv( GL_ARRAY_BUFFER_BINDING, ( GLint * )&state.ArrayBuffer );
+#ifndef IMGUI_IMPL_OPENGL_ES2
+  glGetIntegerv( GL_VERTEX_ARRAY_BINDING, ( GLint * )&state.VertexArrayObject );
+#endif
+#ifdef GL_POLYGON_MODE
+  glGetIntegerv( GL_POLYGON_MODE, state.PolygonMode );
+#endif
+  glGetIntegerv( GL_VIEWPORT, state.Viewport );
+  glGetIntegerv( GL_SCISSOR_BOX, state.ScissorBox );
+  glGetIntegerv( GL_BLEND_SRC_RGB, ( GLint * )&state.BlendSrcRgb );
+  glGetIntegerv( GL_BLEND_DST_RGB, ( GLint * )&state.BlendDstRgb );
+  glGetIntegerv( GL_BLEND_SRC_ALPHA, ( GLint * )&state.BlendSrcAlpha );
+  glGetIntegerv( GL_BLEND_DST_ALPHA, ( GLint * )&state.BlendDstAlpha );
+  glGetIntegerv( GL_BLEND_EQUATION_RGB, ( GLint * )&state.BlendEquationRgb );
+  glGetIntegerv( GL_BLEND_EQUATION_ALPHA, ( GLint * )&state.BlendEquationAlpha );
+  state.EnableBlend = glIsEnabled( GL_BLEND );
+  state.EnableCullFace = glIsEnabled( GL_CULL_FACE );
+  state.EnableDepthTest = glIsEnabled( GL_DEPTH_TEST );
+  state.EnableScissorTest = glIsEnabled( GL_SCISSOR_TEST );
+}
+
+static void ImGui_ImplOpenGL3_RestoreState( const ImGui_ImplOpenGL3_SavedState &state ) {
+  glUseProgram( state.Program );
+  glBindTexture( GL_TEXTURE_2D, state.Texture );
+#ifdef GL_SAMPLER_BINDING
+  glBindSampler( 0, state.Sampler );
+#endif
+  glActiveTexture( state.ActiveTexture );
+#ifndef IMGUI_IMPL_OPENGL_ES2
+  glBindVertexArray( state.VertexArrayObject );
+#endif
+  glBindBuffer( GL_ARRAY_BUFFER, state.ArrayBuffer );
+  glBlendEquationSeparate( state.BlendEquationRgb, state.BlendEquationAlpha );
+  glBlendFuncSeparate( state.BlendSrcRgb, state.BlendDstRgb, state.BlendSrcAlpha, state.BlendDstAlpha );
+
+  if( state.EnableBlend ) {
+    glEnable( GL_BLEND );
+  } else {
+    glDisable( GL_BLEND );
+  }
+
+  if( state.EnableCullFace ) {
+    glEnable( GL_CULL_FACE );
+  } else {
+    glDisable( GL_CULL_FACE );
+  }
+
+  if( state.EnableDepthTest ) {
+    glEnable( GL_DEPTH_TEST );
+  } else {
+    glDisable( GL_DEPTH_TEST );
+  }
+
+  if( state.EnableScissorTest ) {
+    glEnable( GL_SCISSOR_TEST );
+  } else {
+    glDisable( GL_SCISSOR_TEST );
+  }
+
+#ifdef GL_POLYGON_MODE
+  glPolygonMode( GL_FRONT_AND_BACK, ( GLenum )state.PolygonMode[0] );
+#endif
+  glViewport( state.Viewport[0], state.Viewport[1], ( GLsizei )state.Viewport[2], ( GLsizei )state.Viewport[3] );
+  glScissor( state.ScissorBox[0], state.ScissorBox[1], ( GLsizei )state.ScissorBox[2], ( GLsizei )state.ScissorBox[3] );
 }
 
 // OpenGL3 Render function.
@@ -316,72 +587,83 @@ void    ImGui_ImplOpenGL3_RenderDrawData( ImDrawData *draw_data ) {
     return;
   }
 
-  // Backup GL state
-  GLenum last_active_texture;
-  glGetIntegerv( GL_ACTIVE_TEXTURE, ( GLint * )&last_active_texture );
-  glActiveTexture( GL_TEXTURE0 );
-  GLuint last_program;
-  glGetIntegerv( GL_CURRENT_PROGRAM, ( GLint * )&last_program );
-  GLuint last_texture;
-  glGetIntegerv( GL_TEXTURE_BINDING_2D, ( GLint * )&last_texture );
-#ifdef GL_SAMPLER_BINDING
-  GLuint last_sampler;
-  glGetIntegerv( GL_SAMPLER_BINDING, ( GLint * )&last_sampler );
+  // Pack the vertices first, their layout decides how the attributes and projection are set up
+  const bool compact = g_CompactVertices && ImGui_ImplOpenGL3_PackCompact( draw_data );
+  const bool compact_changed = compact != g_State.Compact;
+  g_State.Compact = compact;
+
+  // Setup desired GL state
+  ImGui_ImplOpenGL3_SavedState saved_state;
+  GLuint vertex_array_object = 0;
+
+  if( g_ExclusiveContext ) {
+    // Nothing to back up, and the state set up by the previous frames is still there
+#ifndef IMGUI_IMPL_OPENGL_ES2
+
+    if( g_VaoHandle == 0 ) {
+      glGenVertexArrays( 1, &g_VaoHandle );
+    }
+
 #endif
-  GLuint last_array_buffer;
-  glGetIntegerv( GL_ARRAY_BUFFER_BINDING, ( GLint * )&last_array_buffer );
+    vertex_array_object = g_VaoHandle;
+
+    if( !g_State.Valid ) {
+      glActiveTexture( GL_TEXTURE0 );
+      ImGui_ImplOpenGL3_SetupRenderState( draw_data, fb_width, fb_height, vertex_array_object );
+      g_State.Valid = true;
+    } else {
+      // The application sets its own viewport to clear, and the scissor test is off between frames
+      glViewport( 0, 0, ( GLsizei )fb_width, ( GLsizei )fb_height );
+      glEnable( GL_SCISSOR_TEST );
+
+      // Binding is cheap, creating buffers or textures elsewhere between frames leaves theirs bound.
+      // Without a VAO the element buffer binding would then receive our indices.
 #ifndef IMGUI_IMPL_OPENGL_ES2
-  GLuint last_vertex_array_object;
-  glGetIntegerv( GL_VERTEX_ARRAY_BINDING, ( GLint * )&last_vertex_array_object );
+      glBindVertexArray( vertex_array_object );
 #endif
-#ifdef GL_POLYGON_MODE
-  GLint last_polygon_mode[2];
-  glGetIntegerv( GL_POLYGON_MODE, last_polygon_mode );
-#endif
-  GLint last_viewport[4];
-  glGetIntegerv( GL_VIEWPORT, last_viewport );
-  GLint last_scissor_box[4];
-  glGetIntegerv( GL_SCISSOR_BOX, last_scissor_box );
-  GLenum last_blend_src_rgb;
-  glGetIntegerv( GL_BLEND_SRC_RGB, ( GLint * )&last_blend_src_rgb );
-  GLenum last_blend_dst_rgb;
-  glGetIntegerv( GL_BLEND_DST_RGB, ( GLint * )&last_blend_dst_rgb );
-  GLenum last_blend_src_alpha;
-  glGetIntegerv( GL_BLEND_SRC_ALPHA, ( GLint * )&last_blend_src_alpha );
-  GLenum last_blend_dst_alpha;
-  glGetIntegerv( GL_BLEND_DST_ALPHA, ( GLint * )&last_blend_dst_alpha );
-  GLenum last_blend_equation_rgb;
-  glGetIntegerv( GL_BLEND_EQUATION_RGB, ( GLint * )&last_blend_equation_rgb );
-  GLenum last_blend_equation_alpha;
-  glGetIntegerv( GL_BLEND_EQUATION_ALPHA, ( GLint * )&last_blend_equation_alpha );
-  GLboolean last_enable_blend = glIsEnabled( GL_BLEND );
-  GLboolean last_enable_cull_face = glIsEnabled( GL_CULL_FACE );
-  GLboolean last_enable_depth_test = glIsEnabled( GL_DEPTH_TEST );
-  GLboolean last_enable_scissor_test = glIsEnabled( GL_SCISSOR_TEST );
+      glUseProgram( g_ShaderHandle );
+      glBindBuffer( GL_ARRAY_BUFFER, g_VboHandle );
+      glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, g_ElementsHandle );
+      g_State.Bound = false;
+
+      if( compact_changed || draw_data->DisplayPos.x != g_State.DisplayPos.x || draw_data->DisplayPos.y != g_State.DisplayPos.y ||
+          draw_data->DisplaySize.x != g_State.DisplaySize.x || draw_data->DisplaySize.y != g_State.DisplaySize.y ) {
+        ImGui_ImplOpenGL3_SetupProjection( draw_data );
+      }
 
-  // Setup desired GL state
-  // Recreate the VAO every time (this is to easily allow multiple GL contexts to be rendered to. VAO are not shared among GL contexts)
-  // The renderer would actually work without any VAO bound, but then our VertexAttrib calls would overwrite the default one currently bound.
-  GLuint vertex_array_object = 0;
+      if( compact_changed ) {
+        ImGui_ImplOpenGL3_SetupVertexAttribs( 0 );
+        g_State.VtxOffset = 0;
+      }
+    }
+  } else {
+    ImGui_ImplOpenGL3_BackupState( saved_state );
+
+    // Recreate the VAO every time (this is to easily allow multiple GL contexts to be rendered to. VAO are not shared among GL contexts)
+    // The renderer would actually work without any VAO bound, but then our VertexAttrib calls would overwrite the default one currently bound.
 #ifndef IMGUI_IMPL_OPENGL_ES2
-  glGenVertexArrays( 1, &vertex_array_object );
+    glGenVertexArrays( 1, &vertex_array_object );
 #endif
-  ImGui_ImplOpenGL3_SetupRenderState( draw_data, fb_width, fb_height, vertex_array_object );
+    ImGui_ImplOpenGL3_SetupRenderState( draw_data, fb_width, fb_height, vertex_array_object );
+  }
+
+  // Upload vertex/index buffers, draw commands index into them with the offset of their draw list
+  ImGui_ImplOpenGL3_UploadDrawData( draw_data );
 
   // Will project scissor/clipping rectangles into framebuffer space
   ImVec2 clip_off = draw_data->DisplayPos;         // (0,0) unless using multi-viewports
   ImVec2 clip_scale = draw_data->FramebufferScale; // (1,1) unless using retina display which are often (2,2)
 
   // Render command lists
+  unsigned int list_vtx_offset = 0, list_idx_offset = 0;
+
   for( int n = 0; n < draw_data->CmdListsCount; n++ ) {
     const ImDrawList *cmd_list = draw_data->CmdLists[n];
 
-    // Upload vertex/index buffers
-    glBufferData( GL_ARRAY_BUFFER, ( GLsizeiptr )cmd_list->VtxBuffer.Size * ( int )sizeof( ImDrawVert ), ( const GLvoid * )cmd_list->VtxBuffer.Data, GL_STREAM_DRAW );
-    glBufferData( GL_ELEMENT_ARRAY_BUFFER, ( GLsizeiptr )cmd_list->IdxBuffer.Size * ( int )sizeof( ImDrawIdx ), ( const GLvoid * )cmd_list->IdxBuffer.Data, GL_STREAM_DRAW );
-
     for( int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++ ) {
       const ImDrawCmd *pcmd = &cmd_list->CmdBuffer[cmd_i];
+      const unsigned int cmd_vtx_offset = list_vtx_offset + pcmd->VtxOffset;
+      const unsigned int cmd_idx_offset = list_idx_offset + pcmd->IdxOffset;
 
       if( pcmd->UserCallback != NULL ) {
         // User callback, registered via ImDrawList::AddCallback()
@@ -390,6 +672,10 @@ void    ImGui_ImplOpenGL3_RenderDrawData( ImDrawData *draw_data ) {
           ImGui_ImplOpenGL3_SetupRenderState( draw_data, fb_width, fb_height, vertex_array_object );
         } else {
           pcmd->UserCallback( cmd_list, pcmd );
+
+          // The callback may have changed anything, set everything up again next frame
+          g_State.Bound = false;
+          g_State.Valid = false;
         }
       } else {
         // Project scissor/clipping rectangles into framebuffer space
@@ -401,70 +687,57 @@ void    ImGui_ImplOpenGL3_RenderDrawData( ImDrawData *draw_data ) {
 
         if( clip_rect.x < fb_width && clip_rect.y < fb_height && clip_rect.z >= 0.0f && clip_rect.w >= 0.0f ) {
           // Apply scissor/clipping rectangle
-          glScissor( ( int )clip_rect.x, ( int )( fb_height - clip_rect.w ), ( int )( clip_rect.z - clip_rect.x ), ( int )( clip_rect.w - clip_rect.y ) );
+          const GLint scissor_box[4] = { ( int )clip_rect.x, ( int )( fb_height - clip_rect.w ), ( int )( clip_rect.z - clip_rect.x ), ( int )( clip_rect.w - clip_rect.y ) };
+
+          if( !g_State.Bound || memcmp( scissor_box, g_State.ScissorBox, sizeof( scissor_box ) ) != 0 ) {
+            glScissor( scissor_box[0], scissor_box[1], scissor_box[2], scissor_box[3] );
+            memcpy( g_State.ScissorBox, scissor_box, sizeof( scissor_box ) );
+          }
 
           // Bind texture, Draw
-          glBindTexture( GL_TEXTURE_2D, ( GLuint )( intptr_t )pcmd->TextureId );
+          const GLuint texture = ( GLuint )( intptr_t )pcmd->TextureId;
+
+          if( !g_State.Bound || texture != g_State.Texture ) {
+            glBindTexture( GL_TEXTURE_2D, texture );
+            g_State.Texture = texture;
+          }
+
+          g_State.Bound = true;
 #if IMGUI_IMPL_OPENGL_MAY_HAVE_VTX_OFFSET
 
           if( g_GlVersion >= 320 ) {
-            glDrawElementsBaseVertex( GL_TRIANGLES, ( GLsizei )pcmd->ElemCount, sizeof( ImDrawIdx ) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, ( void * )( intptr_t )( pcmd->IdxOffset * sizeof( ImDrawIdx ) ), ( GLint )pcmd->VtxOffset );
+            glDrawElementsBaseVertex( GL_TRIANGLES, ( GLsizei )pcmd->ElemCount, sizeof( ImDrawIdx ) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, ( void * )( intptr_t )( cmd_idx_offset * sizeof( ImDrawIdx ) ), ( GLint )cmd_vtx_offset );
           } else
 #endif
-            glDrawElements( GL_TRIANGLES, ( GLsizei )pcmd->ElemCount, sizeof( ImDrawIdx ) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, ( void * )( intptr_t )( pcmd->IdxOffset * sizeof( ImDrawIdx ) ) );
+          {
+            // Emulated base vertex, only touch the attributes when a new draw list or 64k block of vertices starts
+            if( cmd_vtx_offset != g_State.VtxOffset ) {
+              ImGui_ImplOpenGL3_SetupVertexAttribs( cmd_vtx_offset );
+              g_State.VtxOffset = cmd_vtx_offset;
+            }
+
+            glDrawElements( GL_TRIANGLES, ( GLsizei )pcmd->ElemCount, sizeof( ImDrawIdx ) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, ( void * )( intptr_t )( cmd_idx_offset * sizeof( ImDrawIdx ) ) );
+          }
         }
       }
     }
-  }
 
-  // Destroy the temporary VAO
-#ifndef IMGUI_IMPL_OPENGL_ES2
-  glDeleteVertexArrays( 1, &vertex_array_object );
-#endif
-
-  // Restore modified GL state
-  glUseProgram( last_program );
-  glBindTexture( GL_TEXTURE_2D, last_texture );
-#ifdef GL_SAMPLER_BINDING
-  glBindSampler( 0, last_sampler );
-#endif
-  glActiveTexture( last_active_texture );
-#ifndef IMGUI_IMPL_OPENGL_ES2
-  glBindVertexArray( last_vertex_array_object );
-#endif
-  glBindBuffer( GL_ARRAY_BUFFER, last_array_buffer );
-  glBlendEquationSeparate( last_blend_equation_rgb, last_blend_equation_alpha );
-  glBlendFuncSeparate( last_blend_src_rgb, last_blend_dst_rgb, last_blend_src_alpha, last_blend_dst_alpha );
-
-  if( last_enable_blend ) {
-    glEnable( GL_BLEND );
-  } else {
-    glDisable( GL_BLEND );
+    list_vtx_offset += cmd_list->VtxBuffer.Size;
+    list_idx_offset += cmd_list->IdxBuffer.Size;
   }
 
-  if( last_enable_cull_face ) {
-    glEnable( GL_CULL_FACE );
-  } else {
-    glDisable( GL_CULL_FACE );
-  }
-
-  if( last_enable_depth_test ) {
-    glEnable( GL_DEPTH_TEST );
+  if( g_ExclusiveContext ) {
+    // Let the application clear the whole framebuffer
+    glDisable( GL_SCISSOR_TEST );
   } else {
-    glDisable( GL_DEPTH_TEST );
-  }
+    // Destroy the temporary VAO
+#ifndef IMGUI_IMPL_OPENGL_ES2
+    glDeleteVertexArrays( 1, &vertex_array_object );
+#endif
 
-  if( last_enable_scissor_test ) {
-    glEnable( GL_SCISSOR_TEST );
-  } else {
-    glDisable( GL_SCISSOR_TEST );
+    // Restore modified GL state
+    ImGui_ImplOpenGL3_RestoreState( saved_state );
   }
-
-#ifdef GL_POLYGON_MODE
-  glPolygonMode( GL_FRONT_AND_BACK, ( GLenum )last_polygon_mode[0] );
-#endif
-  glViewport( last_viewport[0], last_viewport[1], ( GLsizei )last_viewport[2], ( GLsizei )last_viewport[3] );
-  glScissor( last_scissor_box[0], last_scissor_box[1], ( GLsizei )last_scissor_box[2], ( GLsizei )last_scissor_box[3] );
 }
 
 bool ImGui_ImplOpenGL3_CreateFontsTexture() {
@@ -501,6 +774,7 @@ void ImGui_ImplOpenGL3_DestroyFontsTexture() {
     glDeleteTextures( 1, &g_FontTexture );
     io.Fonts->TexID = 0;
     g_FontTexture = 0;
+    g_State.Bound = false; // Deleting a bound texture unbinds it
   }
 }
 
@@ -721,13 +995,29 @@ void    ImGui_ImplOpenGL3_DestroyDeviceObjects() {
   if( g_VboHandle )        {
     glDeleteBuffers( 1, &g_VboHandle );
     g_VboHandle = 0;
+    g_VboSize = 0;
   }
 
   if( g_ElementsHandle )   {
     glDeleteBuffers( 1, &g_ElementsHandle );
     g_ElementsHandle = 0;
+    g_ElementsSize = 0;
+  }
+
+  g_VtxStaging.clear();
+  g_IdxStaging.clear();
+  g_CompactStaging.clear();
+
+#ifndef IMGUI_IMPL_OPENGL_ES2
+
+  if( g_VaoHandle )        {
+    glDeleteVertexArrays( 1, &g_VaoHandle );
+    g_VaoHandle = 0;
   }
 
+#endif
+  g_State.Valid = false;
+
   if( g_ShaderHandle && g_VertHandle ) {
     glDetachShader( g_ShaderHandle, g_VertHandle );
   }
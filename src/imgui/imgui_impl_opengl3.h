@@ -5,7 +5,7 @@
 
 // Implemented features:
 //  [X] Renderer: User texture binding. Use 'GLuint' OpenGL texture identifier as void*/ImTextureID. Read the FAQ about ImTextureID!
-//  [x] Renderer: Desktop GL only: Support for large meshes (64k+ vertices) with 16-bit indices.
+//  [x] Renderer: Support for large meshes (64k+ vertices) with 16-bit indices. GL ES / WebGL emulate the base vertex by re-pointing the vertex attributes.
 
 // You can copy and use unmodified imgui_impl_* files in your project. See main.cpp for an example of using this.
 // If you are new to dear imgui, read examples/README.txt and read the documentation at the top of imgui.cpp.
@@ -36,6 +36,24 @@ IMGUI_IMPL_API void     ImGui_ImplOpenGL3_DestroyFontsTexture();
 IMGUI_IMPL_API bool     ImGui_ImplOpenGL3_CreateDeviceObjects();
 IMGUI_IMPL_API void     ImGui_ImplOpenGL3_DestroyDeviceObjects();
 
+// (Optional) When the application owns the GL context and doesn't change any GL state between frames besides the viewport
+// and clearing, skip the backup/restore of the GL state and keep our render state set up from one frame to the next.
+// The scissor test is left disabled between frames.
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_SetExclusiveContext( bool exclusive );
+
+// (Optional) With an exclusive context, call after changing GL state outside of a draw callback, e.g. setting up vertex
+// attributes or a program, so the next frame sets up its render state again.
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_InvalidateState();
+
+// (Optional) When rendering into a texture cleared to transparent, blend alpha as coverage so the texture ends up with
+// premultiplied alpha. Draw that texture with glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA) to get what direct rendering would.
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_SetPremultipliedTarget( bool premultiplied );
+
+// (Optional) Upload 12 byte vertices instead of 20 byte ImDrawVert: positions as 1/8 pixel fixed point and UVs as 16 bit
+// unorm. Frames with a vertex beyond 4096 pixels of DisplayPos, or a UV outside 0..1, are uploaded as ImDrawVert.
+// Packing is an extra pass over every vertex on the CPU, see `xmake bench-vertices` before turning it on.
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_SetCompactVertices( bool compact );
+
 // Specific OpenGL ES versions
 //#define IMGUI_IMPL_OPENGL_ES2     // Auto-detected on Emscripten
 //#define IMGUI_IMPL_OPENGL_ES3     // Auto-detected on iOS/Android
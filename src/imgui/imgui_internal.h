@@ -96,6 +96,7 @@ struct ImGuiContext;                // Main Dear ImGui context
 struct ImGuiDataTypeInfo;           // Type information associated to a ImGuiDataType enum
 struct ImGuiGroupData;              // Stacked storage data for BeginGroup()/EndGroup()
 struct ImGuiInputTextState;         // Internal state of the currently focused/edited text input box
+struct ImGuiInputTextLineIndex;     // Line offsets of a read-only multi-line text input box
 struct ImGuiLastItemDataBackup;     // Backup and restore IsItemHovered() internal data
 struct ImGuiMenuColumns;            // Simple column measurement, currently used for MenuItem() only
 struct ImGuiNavMoveResult;          // Result of a gamepad/keyboard directional navigation move query result
@@ -108,6 +109,7 @@ struct ImGuiTabBar;                 // Storage for a tab bar
 struct ImGuiTabItem;                // Storage for a tab item (within a tab bar)
 struct ImGuiWindow;                 // Storage for one window
 struct ImGuiWindowTempData;         // Temporary storage for one window (that's the data which in theory we could ditch at the end of the frame)
+struct ImGuiWindowRetained;         // Draw commands of a window's contents kept between frames, see RetainWindowContents()
 struct ImGuiWindowSettings;         // Storage for a window .ini settings (we keep one of those even if the actual window wasn't instanced during this session)
 
 // Use your programming IDE "Go to definition" facility on the names of the center columns to find the actual flags/enum lists.
@@ -805,12 +807,27 @@ struct IMGUI_API ImPool {
   void        Clear()                             {
     for( int n = 0; n < Map.Data.Size; n++ ) {
       int idx = Map.Data[n].val_i;
+#ifdef IMGUI_USE_HASHED_STORAGE
+
+      if( Map.Data[n].key == 0 ) { // Free slot
+        continue;
+      }
+
+#endif
 
       if( idx != -1 ) {
         Buf[idx].~T();
       }
     }
 
+#ifdef IMGUI_USE_HASHED_STORAGE
+
+    if( Map.HasZeroPair && Map.ZeroPair.val_i != -1 ) {
+      Buf[Map.ZeroPair.val_i].~T();
+    }
+
+#endif
+
     Map.Clear();
     Buf.clear();
     FreeIdx = 0;
@@ -919,11 +936,52 @@ struct IMGUI_API ImChunkStream {
 #define IM_DRAWLIST_CIRCLE_AUTO_SEGMENT_MAX                     512
 #define IM_DRAWLIST_CIRCLE_AUTO_SEGMENT_CALC(_RAD,_MAXERROR)    ImClamp((int)((IM_PI * 2.0f) / ImAcos(((_RAD) - (_MAXERROR)) / (_RAD))), IM_DRAWLIST_CIRCLE_AUTO_SEGMENT_MIN, IM_DRAWLIST_CIRCLE_AUTO_SEGMENT_MAX)
 
+// ImDrawList: Segment count of an auto-tessellated cubic bezier from the largest second difference of its control points (Wang's formula).
+// The distance between the curve and the segments stays under 0.75 * _TOL.
+#define IM_DRAWLIST_BEZIER_AUTO_SEGMENT_MAX                     1024
+#define IM_DRAWLIST_BEZIER_AUTO_SEGMENT_CALC(_SECOND_DIFF,_TOL) ImClamp((int)ImCeil(ImSqrt((_SECOND_DIFF) / (_TOL))), 1, IM_DRAWLIST_BEZIER_AUTO_SEGMENT_MAX)
+
 // ImDrawList: You may set this to higher values (e.g. 2 or 3) to increase tessellation of fast rounded corners path.
 #ifndef IM_DRAWLIST_ARCFAST_TESSELLATION_MULTIPLIER
 #define IM_DRAWLIST_ARCFAST_TESSELLATION_MULTIPLIER             1
 #endif
 
+// ImDrawList: AddText() caches runs up to this many bytes, and drops them after this many frames without being drawn.
+#define IM_DRAWLIST_TEXT_RUN_MAX_LENGTH                         512
+#define IM_DRAWLIST_TEXT_RUN_MAX_COUNT                          4096
+#define IM_DRAWLIST_TEXT_RUN_MAX_AGE                            60
+
+// Glyph quads of a text run relative to its pixel aligned position, see ImFont::RenderText()
+struct ImDrawTextRun {
+  ImGuiID         Key;                        // Hash of the font, size and text
+  const ImFont   *Font;
+  float           Size;
+  int             TextOffset;                 // Copy of the text in ImDrawTextRunCache::Text, to rule out hash collisions
+  int             TextLength;
+  int             QuadOffset;                 // Position and UV rectangles of each glyph in ImDrawTextRunCache::Quads
+  int             QuadCount;
+  ImVec4          Bounds;                     // Rectangle covering all the quads
+  int             LastFrame;
+};
+
+// Text runs drawn by AddText() without wrapping or fine clipping, drawing the same text again only translates its quads
+struct IMGUI_API ImDrawTextRunCache {
+  ImGuiStorage            Map;                // Key -> index in Runs + 1
+  ImVector<ImDrawTextRun> Runs;
+  ImVector<char>          Text;
+  ImVector<ImVec4>        Quads;
+  ImTextureID             TexID;              // Font atlas the runs were built for
+  int                     Frame;
+
+  ImDrawTextRunCache()    {
+    TexID = NULL;
+    Frame = 0;
+  }
+  void                    Clear();
+  void                    NewFrame( ImTextureID tex_id );   // Ages the runs and drops the stale ones, everything if the atlas changed
+  const ImDrawTextRun    *GetRun( const ImFont *font, float size, const char *text_begin, const char *text_end ); // NULL when the run can't be cached
+};
+
 // Data shared between all ImDrawList instances
 // You may want to create your own instance of this if you want to use ImDrawList completely without ImGui. In that case, watch out for future changes to this structure.
 struct IMGUI_API ImDrawListSharedData {
@@ -939,9 +997,13 @@ struct IMGUI_API ImDrawListSharedData {
   ImVec2          ArcFastVtx[12 * IM_DRAWLIST_ARCFAST_TESSELLATION_MULTIPLIER];  // FIXME: Bake rounded corners fill/borders in atlas
   ImU8            CircleSegmentCounts[64];    // Precomputed segment count for given radius (array index + 1) before we calculate it dynamically (to avoid calculation overhead)
   const ImVec4   *TexUvLines;                 // UV of anti-aliased lines in the atlas
+  mutable ImVector<ImVec2> CircleVtx;         // Unit circle points of every segment count used so far, built on first use by GetCircleVtx()
+  mutable int     CircleVtxOffsets[IM_DRAWLIST_CIRCLE_AUTO_SEGMENT_MAX + 1]; // Offset in CircleVtx of the points for a segment count, -1 until built
+  mutable ImDrawTextRunCache TextRuns;        // Filled by AddText(), call TextRuns.NewFrame() once per frame when using ImDrawList without ImGui
 
   ImDrawListSharedData();
   void SetCircleSegmentMaxError( float max_error );
+  const ImVec2 *GetCircleVtx( int num_segments ) const; // num_segments points of a closed unit circle, for num_segments in [3, IM_DRAWLIST_CIRCLE_AUTO_SEGMENT_MAX]
 };
 
 struct ImDrawDataBuilder {
@@ -1286,6 +1348,23 @@ struct IMGUI_API ImGuiInputTextState {
   }
 };
 
+// Where the lines of a read-only multi-line text input box start, so only the visible ones are laid out every frame
+// The index is kept while the buffer pointer, length and a sampled hash of the buffer stay the same, and checked against the lines it renders.
+struct IMGUI_API ImGuiInputTextLineIndex {
+  const char             *Buf;                    // user buffer the index was built from
+  int                     Len;                    // its UTF-8 length, without the zero-terminator
+  ImU32                   Hash;                   // sampled hash of Buf[0..Len]
+  int                     BuildFrame;             // frame the index was last (re)built
+  ImVector<int>           LineStarts;             // byte offset of every line in Buf, the first one being 0
+
+  ImGuiInputTextLineIndex()               {
+    Buf = NULL;
+    Len = 0;
+    Hash = 0;
+    BuildFrame = -1;
+  }
+};
+
 // Storage for current popup stack
 struct ImGuiPopupData {
   ImGuiID             PopupId;        // Set on OpenPopup()
@@ -1700,6 +1779,7 @@ struct ImGuiContext {
   // Widget state
   ImVec2                  LastValidMousePos;
   ImGuiInputTextState     InputTextState;
+  ImPool<ImGuiInputTextLineIndex> InputTextLineIndexes;       // Read-only multi-line text input boxes, by widget id
   ImFont                  InputTextPasswordFont;
   ImGuiID                 TempInputId;                        // Temporary text input when CTRL+clicking on a slider, etc.
   ImGuiColorEditFlags     ColorEditOptions;                   // Store user options for color edit widgets
@@ -1989,6 +2069,37 @@ struct IMGUI_API ImGuiWindowTempData {
   }
 };
 
+// Draw commands of a window's contents kept from one frame to the next, see RetainWindowContents()
+// The buffers are the tail of the window's draw list, from the command that was current when the contents started.
+struct IMGUI_API ImGuiWindowRetained {
+  ImU32                   Key;                    // Key the buffers were recorded with (0: nothing recorded)
+  ImU32                   RecordingKey;           // Key of the contents being recorded until End() (0: not recording)
+  int                     VtxBegin, IdxBegin, CmdBegin; // Draw list sizes when the contents started, CmdBegin is the command that was current
+  int                     ClipRectStackSize, TextureIdStackSize;
+  unsigned int            VtxCurrentIdx;          // Draw list state after the contents
+  ImDrawCmd               CmdHeader;
+  ImVec2                  CursorMaxPos;           // window->DC state after the contents, read by the next frame
+  int                     NavLayerActiveMaskNext;
+  ImVector<ImDrawVert>    VtxBuffer;
+  ImVector<ImDrawIdx>     IdxBuffer;
+  ImVector<ImDrawCmd>     CmdBuffer;
+
+  ImGuiWindowRetained()   {
+    Key = RecordingKey = 0;
+    VtxBegin = IdxBegin = CmdBegin = 0;
+    ClipRectStackSize = TextureIdStackSize = 0;
+    VtxCurrentIdx = 0;
+    CursorMaxPos = ImVec2( 0.0f, 0.0f );
+    NavLayerActiveMaskNext = 0;
+  }
+  void                    Clear()                 {
+    Key = RecordingKey = 0;
+    VtxBuffer.clear();
+    IdxBuffer.clear();
+    CmdBuffer.clear();
+  }
+};
+
 // Storage for one window
 struct IMGUI_API ImGuiWindow {
   char                   *Name;                               // Window name, owned by the window.
@@ -2064,6 +2175,7 @@ struct IMGUI_API ImGuiWindow {
 
   ImDrawList             *DrawList;                           // == &DrawListInst (for backward compatibility reason with code using imgui_internal.h we keep this a pointer)
   ImDrawList              DrawListInst;
+  ImGuiWindowRetained     Retained;                           // Contents kept from the previous frame when opted-in with RetainWindowContents()
   ImGuiWindow            *ParentWindow;                       // If we are a child _or_ popup window, this is pointing to our parent. Otherwise NULL.
   ImGuiWindow            *RootWindow;                         // Point to ourself or first ancestor that is not a child window == Top-level window.
   ImGuiWindow            *RootWindowForTitleBarHighlight;     // Point to ourself or first ancestor which will display TitleBgActive color when this window is active.
@@ -2579,6 +2691,8 @@ IMGUI_API void              ImFontAtlasBuildFinish( ImFontAtlas *atlas );
 IMGUI_API void              ImFontAtlasBuildRender1bppRectFromString( ImFontAtlas *atlas, int atlas_x, int atlas_y, int w, int h, const char *in_str, char in_marker_char, unsigned char in_marker_pixel_value );
 IMGUI_API void              ImFontAtlasBuildMultiplyCalcLookupTable( unsigned char out_table[256], float in_multiply_factor );
 IMGUI_API void              ImFontAtlasBuildMultiplyRectAlpha8( const unsigned char table[256], unsigned char *pixels, int x, int y, int w, int h, int stride );
+IMGUI_API bool              ImFontAtlasBuildSaveBaked( ImFontAtlas *atlas, ImVector<unsigned char> *out_blob );         // Serialize a built atlas (fonts, glyphs, custom rects and alpha8 pixels)
+IMGUI_API bool              ImFontAtlasBuildLoadBaked( ImFontAtlas *atlas, const void *blob, int blob_size );          // Restore a saved atlas as RGBA32 without rasterizing, leaves it cleared if the blob doesn't match this build
 
 //-----------------------------------------------------------------------------
 // [SECTION] Test Engine Hooks (imgui_test_engine)
@@ -3997,6 +3997,107 @@ bool ImGui::InputTextWithHint( const char *label, const char *hint, char *buf, s
   return InputTextEx( label, hint, buf, ( int )buf_size, ImVec2( 0, 0 ), flags, callback, user_data );
 }
 
+// Hash of a whole small buffer, or of both ends and evenly spread blocks of a large one so we don't read megabytes every frame.
+// Line breaks moved outside of the blocks without changing the length are caught by InputTextCheckLines() once their lines are visible.
+static ImU32 InputTextHashSample( const char *buf, int len ) {
+  const int block_size = 256;
+  const int block_count = 32;
+
+  if( len <= block_size * block_count ) {
+    return ImHashData( buf, ( size_t )len );
+  }
+
+  const int step = ( len - block_size ) / ( block_count - 1 );
+  ImU32 hash = ImHashData( buf + len - block_size, block_size );
+
+  for( int n = 0; n < block_count - 1; n++ ) {
+    hash = ImHashData( buf + n * step, block_size, hash );
+  }
+
+  return hash;
+}
+
+static void InputTextBuildLineIndex( ImGuiInputTextLineIndex *index, const char *buf ) {
+  ImGuiContext &g = *GImGui;
+  const int len = ( int )strlen( buf );
+  const char *buf_end = buf + len;
+  index->Buf = buf;
+  index->Len = len;
+  index->Hash = InputTextHashSample( buf, len );
+  index->BuildFrame = g.FrameCount;
+  index->LineStarts.resize( 0 );
+  index->LineStarts.push_back( 0 );
+
+  for( const char *s = buf; ( s = ( const char * )memchr( s, '\n', ( size_t )( buf_end - s ) ) ) != NULL; )
+    index->LineStarts.push_back( ( int )( ++s - buf ) );
+}
+
+// Line index of a read-only multi-line text, rebuilt when the buffer is not the one it was built from.
+// Reads the zero-terminator and a few blocks of the buffer, not all of it.
+static ImGuiInputTextLineIndex *InputTextGetLineIndex( ImGuiID id, const char *buf, int buf_size ) {
+  ImGuiContext &g = *GImGui;
+  ImGuiInputTextLineIndex *index = g.InputTextLineIndexes.GetOrAddByKey( id );
+
+  if( index->Buf != buf || index->Len >= buf_size || buf[index->Len] != 0 || InputTextHashSample( buf, index->Len ) != index->Hash ) {
+    InputTextBuildLineIndex( index, buf );
+  }
+
+  return index;
+}
+
+// End of line 'line_no' in the buffer, before its '\n'
+static int InputTextLineEnd( const ImGuiInputTextLineIndex *index, int line_no ) {
+  return ( line_no + 1 < index->LineStarts.Size ) ? index->LineStarts[line_no + 1] - 1 : index->Len;
+}
+
+// Whether lines [line_begin, line_end) of the buffer still start and end where the index says
+static bool InputTextCheckLines( const ImGuiInputTextLineIndex *index, int line_begin, int line_end ) {
+  for( int line_no = line_begin; line_no < line_end; line_no++ ) {
+    const int start = index->LineStarts[line_no];
+    const int end = InputTextLineEnd( index, line_no );
+
+    if( start > 0 && index->Buf[start - 1] != '\n' ) {
+      return false;
+    }
+
+    if( end < index->Len && index->Buf[end] != '\n' ) {
+      return false;
+    }
+
+    if( memchr( index->Buf + start, '\n', ( size_t )( end - start ) ) || memchr( index->Buf + start, 0, ( size_t )( end - start ) ) ) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Render the lines of a read-only multi-line text which are within the clipping rectangle, straight from the UTF-8 buffer
+static void InputTextRenderVisibleLines( ImGuiWindow *draw_window, ImGuiInputTextLineIndex *index, const ImVec2 &pos, ImU32 col ) {
+  ImGuiContext &g = *GImGui;
+  const ImVec4 &clip_rect = draw_window->DrawList->_CmdHeader.ClipRect;
+  int line_begin, line_end;
+
+  for( int attempt = 0; attempt < 2; attempt++ ) {
+    line_begin = ImClamp( ( int )ImFloor( ( clip_rect.y - pos.y ) / g.FontSize ), 0, index->LineStarts.Size );
+    line_end = ImClamp( ( int )ImFloor( ( clip_rect.w - pos.y ) / g.FontSize ) + 1, line_begin, index->LineStarts.Size );
+
+    // The buffer changed where the sampled hash doesn't look
+    if( attempt == 0 && !InputTextCheckLines( index, line_begin, line_end ) ) {
+      InputTextBuildLineIndex( index, index->Buf );
+      continue;
+    }
+
+    break;
+  }
+
+  if( line_begin < line_end ) {
+    const char *text_begin = index->Buf + index->LineStarts[line_begin];
+    const char *text_end = index->Buf + InputTextLineEnd( index, line_end - 1 );
+    draw_window->DrawList->AddText( g.Font, g.FontSize, ImVec2( pos.x, pos.y + line_begin * g.FontSize ), col, text_begin, text_end );
+  }
+}
+
 static int InputTextCalcTextLenAndLineCount( const char *text_begin, const char **out_text_end ) {
   int line_count = 0;
   const char *s = text_begin;
@@ -4602,9 +4703,15 @@ bool ImGui::InputTextEx( const char *label, const char *hint, char *buf, int buf
   bool value_changed = false;
   bool enter_pressed = false;
 
+  // Read-only multi-line text is rendered from its line index, only laying out the visible lines
+  ImGuiInputTextLineIndex *line_index = ( is_multiline && is_readonly && !is_password ) ? InputTextGetLineIndex( id, buf, buf_size ) : NULL;
+
   // When read-only we always use the live data passed to the function
   // FIXME-OPT: Because our selection/cursor code currently needs the wide text we need to convert it when active, which is not ideal :(
-  if( is_readonly && state != NULL && ( render_cursor || render_selection ) ) {
+  // With a line index we only convert again when the buffer changed, it was (re)built last frame at the latest.
+  const bool readonly_text_changed = line_index == NULL || line_index->BuildFrame >= g.FrameCount - 1;
+
+  if( is_readonly && state != NULL && ( render_cursor || render_selection ) && readonly_text_changed ) {
     const char *buf_end = NULL;
     state->TextW.resize( buf_size + 1 );
     state->CurLenW = ImTextStrFromUtf8( state->TextW.Data, state->TextW.Size, buf, NULL, &buf_end );
@@ -4617,6 +4724,10 @@ bool ImGui::InputTextEx( const char *label, const char *hint, char *buf, int buf
   const bool buf_display_from_state = ( render_cursor || render_selection || g.ActiveId == id ) && !is_readonly && state && state->TextAIsValid;
   const bool is_displaying_hint = ( hint != NULL && ( buf_display_from_state ? state->TextA.Data : buf )[0] == 0 );
 
+  if( is_displaying_hint ) {
+    line_index = NULL;
+  }
+
   // Password pushes a temporary font with only a fallback glyph
   if( is_password && !is_displaying_hint ) {
     const ImFontGlyph *glyph = g.Font->FindGlyph( '*' );
@@ -5068,7 +5179,8 @@ bool ImGui::InputTextEx( const char *label, const char *hint, char *buf, int buf
 
       // Iterate all lines to find our line numbers
       // In multi-line mode, we never exit the loop until all lines are counted, so add one extra to the searches_remaining counter.
-      searches_remaining += is_multiline ? 1 : 0;
+      // The line index already counted them.
+      searches_remaining += ( is_multiline && line_index == NULL ) ? 1 : 0;
       int line_count = 0;
 
       //for (const ImWchar* s = text_begin; (s = (const ImWchar*)wcschr((const wchar_t*)s, (wchar_t)'\n')) != NULL; s++)  // FIXME-OPT: Could use this when wchar_t are 16-bit
@@ -5114,7 +5226,7 @@ bool ImGui::InputTextEx( const char *label, const char *hint, char *buf, int buf
 
       // Store text height (note that we haven't calculated text width at all, see GitHub issues #383, #1224)
       if( is_multiline ) {
-        text_size = ImVec2( inner_size.x, line_count * g.FontSize );
+        text_size = ImVec2( inner_size.x, ( line_index ? line_index->LineStarts.Size : line_count ) * g.FontSize );
       }
     }
 
@@ -5195,7 +5307,9 @@ bool ImGui::InputTextEx( const char *label, const char *hint, char *buf, int buf
     }
 
     // We test for 'buf_display_max_length' as a way to avoid some pathological cases (e.g. single-line 1 MB string) which would make ImDrawList crash.
-    if( is_multiline || ( buf_display_end - buf_display ) < buf_display_max_length ) {
+    if( line_index ) {
+      InputTextRenderVisibleLines( draw_window, line_index, draw_pos - draw_scroll, GetColorU32( ImGuiCol_Text ) );
+    } else if( is_multiline || ( buf_display_end - buf_display ) < buf_display_max_length ) {
       ImU32 col = GetColorU32( is_displaying_hint ? ImGuiCol_TextDisabled : ImGuiCol_Text );
       draw_window->DrawList->AddText( g.Font, g.FontSize, draw_pos - draw_scroll, col, buf_display, buf_display_end, 0.0f, is_multiline ? NULL : &clip_rect );
     }
@@ -5218,7 +5332,10 @@ bool ImGui::InputTextEx( const char *label, const char *hint, char *buf, int buf
     }
   } else {
     // Render text only (no selection, no cursor)
-    if( is_multiline ) {
+    if( line_index ) {
+      text_size = ImVec2( inner_size.x, line_index->LineStarts.Size * g.FontSize );
+      buf_display_end = buf_display + line_index->Len;
+    } else if( is_multiline ) {
       text_size = ImVec2( inner_size.x, InputTextCalcTextLenAndLineCount( buf_display, &buf_display_end ) * g.FontSize );  // We don't need width
     } else if( !is_displaying_hint && g.ActiveId == id ) {
       buf_display_end = buf_display + state->CurLenA;
@@ -5226,7 +5343,9 @@ bool ImGui::InputTextEx( const char *label, const char *hint, char *buf, int buf
       buf_display_end = buf_display + strlen( buf_display );
     }
 
-    if( is_multiline || ( buf_display_end - buf_display ) < buf_display_max_length ) {
+    if( line_index ) {
+      InputTextRenderVisibleLines( draw_window, line_index, draw_pos, GetColorU32( ImGuiCol_Text ) );
+    } else if( is_multiline || ( buf_display_end - buf_display ) < buf_display_max_length ) {
       ImU32 col = GetColorU32( is_displaying_hint ? ImGuiCol_TextDisabled : ImGuiCol_Text );
       draw_window->DrawList->AddText( g.Font, g.FontSize, draw_pos, col, buf_display, buf_display_end, 0.0f, is_multiline ? NULL : &clip_rect );
     }
@@ -16,12 +16,27 @@
 #include <emscripten.h>
 #include <emscripten/html5.h>
 
+#include "site/font_atlas.h"
+#include "site/memory.h"
 #include "site/site.h"
 
 SDL_Window *g_Window = NULL;
 SDL_GLContext g_GLContext = NULL;
 
+// Idle mode: without input, a pending syntax check or an animated script, a
+// frame is only made every IdleInterval seconds instead of at the display rate,
+// and a frame hashing the same as the one on screen isn't drawn at all. The
+// main loop keeps polling events at the display rate, so input wakes it up
+// right away.
+static const int IdleSettleFrames = 4;    // after the last input, for hovers and layout to settle
+static const double IdleInterval = 0.25;  // still fine for the editor's cursor blink
+int g_ActiveFrames = IdleSettleFrames;
+double g_LastFrameTime = 0.0;
+ImU32 g_DrawnHash = 0;
+
 void main_loop( void * );
+bool is_input_held( const ImGuiIO &io );
+ImU32 hash_draw_data( const ImDrawData *draw_data );
 
 int main( int, char ** ) {
 
@@ -70,6 +85,8 @@ int main( int, char ** ) {
 
   //Dear ImGui setup
   IMGUI_CHECKVERSION();
+  // Pooled before the context allocates anything
+  ImGui::SetAllocatorFunctions( Site::PoolAlloc, Site::PoolFree );
   ImGui::CreateContext();
   ImGuiIO &io = ImGui::GetIO();
 
@@ -85,9 +102,14 @@ int main( int, char ** ) {
   // Setup Dear ImGui style
   ImGui::StyleColorsDark();
 
+  // Font atlas baked at build time, rasterized here only if it doesn't match this imgui
+  ImFontAtlasBuildLoadBaked( io.Fonts, Site::FontAtlasBlob, ( int )Site::FontAtlasBlobSize );
+
   // Setup bindings
   ImGui_ImplSDL2_InitForOpenGL( g_Window, g_GLContext );
   ImGui_ImplOpenGL3_Init( "#version 100" );
+  // We own the GL context, no need to save and restore its state every frame
+  ImGui_ImplOpenGL3_SetExclusiveContext( true );
 
   Site::Init();
 
@@ -97,12 +119,28 @@ int main( int, char ** ) {
 void main_loop( void * ) {
   // input polling
   SDL_Event event;
+  bool input = false;
 
   while( SDL_PollEvent( &event ) ) {
     ImGui_ImplSDL2_ProcessEvent( &event );
+    input = true;
   }
 
+  ImGuiIO &io = ImGui::GetIO();
+  double now = emscripten_get_now() / 1000.0;
+
+  if( input || is_input_held( io ) ) {
+    g_ActiveFrames = IdleSettleFrames;
+  } else if( g_ActiveFrames > 0 ) {
+    --g_ActiveFrames;
+  } else if( now - g_LastFrameTime < IdleInterval ) {
+    return;
+  }
+
+  g_LastFrameTime = now;
+
   // Make a frame
+  Site::NewMemoryFrame();
   ImGui_ImplOpenGL3_NewFrame();
   ImGui_ImplSDL2_NewFrame( g_Window );
   ImGui::NewFrame();
@@ -110,10 +148,31 @@ void main_loop( void * ) {
   // Site logic
   Site::Tick();
 
-  // Render a frame
+  const bool animating = Site::IsAnimating();
+
+  if( animating ) {
+    g_ActiveFrames = IdleSettleFrames;
+  }
+
+  // Render a frame, unless it's the one already on screen. Animated frames
+  // differ anyway, hashing their vertices would only cost time.
   ImGui::Render();
+  Site::Compose( ImGui::GetDrawData() );
+
+  if( animating ) {
+    g_DrawnHash = 0;  // so the next still frame is compared against nothing
+  } else {
+    ImU32 hash = hash_draw_data( ImGui::GetDrawData() );
+
+    if( hash == g_DrawnHash ) {
+      return;
+    }
+
+    g_DrawnHash = hash;
+  }
+
   SDL_GL_MakeCurrent( g_Window, g_GLContext );
-  ImGuiIO &io = ImGui::GetIO();
+  Site::RenderLayers();
   glViewport( 0, 0, ( int )io.DisplaySize.x, ( int )io.DisplaySize.y );
 
   static ImVec4 clear_color = ImVec4( 0.66f, 0.66f, 0.66f, 1.00f );
@@ -123,3 +182,44 @@ void main_loop( void * ) {
   ImGui_ImplOpenGL3_RenderDrawData( ImGui::GetDrawData() );
   SDL_GL_SwapWindow( g_Window );
 }
+
+// Held buttons and keys repeat and drag without sending events
+bool is_input_held( const ImGuiIO &io ) {
+  for( bool down : io.MouseDown ) {
+    if( down ) {
+      return true;
+    }
+  }
+
+  for( bool down : io.KeysDown ) {
+    if( down ) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Everything the renderer reads: the display, vertices, indices and commands,
+// plus the shapes drawn by callbacks whose pointers alone don't tell what they draw
+ImU32 hash_draw_data( const ImDrawData *draw_data ) {
+  ImU32 hash = ImHashData( &draw_data->DisplaySize, sizeof( ImVec2 ) );
+  hash = ImHashData( &draw_data->FramebufferScale, sizeof( ImVec2 ), hash );
+
+  for( int n = 0; n < draw_data->CmdListsCount; n++ ) {
+    const ImDrawList *cmd_list = draw_data->CmdLists[n];
+    hash = ImHashData( cmd_list->VtxBuffer.Data, cmd_list->VtxBuffer.size_in_bytes(), hash );
+    hash = ImHashData( cmd_list->IdxBuffer.Data, cmd_list->IdxBuffer.size_in_bytes(), hash );
+
+    for( const ImDrawCmd &cmd : cmd_list->CmdBuffer ) {
+      hash = ImHashData( &cmd.ClipRect, sizeof( ImVec4 ), hash );
+      hash = ImHashData( &cmd.TextureId, sizeof( ImTextureID ), hash );
+      hash = ImHashData( &cmd.VtxOffset, sizeof( unsigned int ), hash );
+      hash = ImHashData( &cmd.IdxOffset, sizeof( unsigned int ), hash );
+      hash = ImHashData( &cmd.ElemCount, sizeof( unsigned int ), hash );
+      hash = ImHashData( &cmd.UserCallback, sizeof( ImDrawCallback ), hash );
+    }
+  }
+
+  return Site::DrawHash( hash );
+}
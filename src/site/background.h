@@ -4,93 +4,303 @@
 #include "../imgui/imgui_internal.h"
 
 #include "../sol/sol.h"
+#include "layers.h"
+#include "memory.h"
+#include "primitives.h"
+#include "sprites.h"
+#include <algorithm>
 #include <emscripten/html5.h>
 
-inline ImDrawList *Draw;
+// Draw list of the scripts, put behind every window by Site::Compose(). It isn't
+// a window's, so it lives as long as the site and keeps its buffers' capacity.
+inline ImDrawList Draw( nullptr );
 
-struct Background {
-  Background() {
-    ImGui::PushStyleVar( ImGuiStyleVar_WindowBorderSize, 0.0f );
-    ImGui::PushStyleVar( ImGuiStyleVar_WindowPadding, { 0.0f, 0.0f } );
-    ImGui::PushStyleColor( ImGuiCol_WindowBg, { 0.0f, 0.0f, 0.0f, 0.0f } );
+// Circles, rectangles and lines of the scripts, drawn by a shader instead of tessellated
+inline Site::Primitives Shapes;
+
+// Layers of draw.layer(), kept across frames
+inline Site::Layers Offscreen;
+
+// Images of draw.image(), shown by draw.sprite()
+inline Site::Sprites Images;
 
-    ImGui::Begin( "##Background", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoInputs );
+// What the bindings draw into, the canvas or the layer being drawn
+inline ImDrawList *Target = &Draw;
+inline Site::Primitives *TargetShapes = &Shapes;
+
+// Shapes of the frame given to the draw list or queued, and the ones skipped for being out of sight
+inline int Emitted = 0;
+inline int Culled = 0;
+
+// Draw list for everything else, queued shapes go first to keep the order they were drawn in
+inline ImDrawList *Canvas() {
+  TargetShapes->Flush( Target );
+  return Target;
+}
 
-    ImGuiIO &io = ImGui::GetIO();
+// Whether the bounds of aPoints grown by aMargin touch the clip rect, so shapes out of sight
+// aren't tessellated or queued. The margin covers thickness and the antialiased edge.
+inline bool Visible( std::initializer_list<ImVec2> aPoints, float aMargin ) {
+  ImVec2 min( FLT_MAX, FLT_MAX ), max( -FLT_MAX, -FLT_MAX );
 
-    ImGui::SetWindowPos( ImVec2( 0, 0 ), ImGuiCond_Always );
-    ImGui::SetWindowSize( ImVec2( io.DisplaySize.x, io.DisplaySize.y ), ImGuiCond_Always );
+  for( const ImVec2 &point : aPoints ) {
+    min = ImMin( min, point );
+    max = ImMax( max, point );
+  }
 
-    ImGui::PopStyleColor();
-    ImGui::PopStyleVar( 2 );
+  const ImVec4 &clip = Target->_CmdHeader.ClipRect;
 
-    Draw = ImGui::FindWindowByName( "##Background" )->DrawList;
+  if( max.x + aMargin < clip.x || max.y + aMargin < clip.y || min.x - aMargin > clip.z || min.y - aMargin > clip.w ) {
+    ++Culled;
+    return false;
+  }
+
+  ++Emitted;
+  return true;
+}
+
+// Half a line and the antialiased edge
+inline float Margin( float aThickness ) {
+  return ImMax( aThickness, 1.0f ) * 0.5f + 1.0f;
+}
+
+// Starts the canvas over for the frame, set up the way ImGui sets up its own background list
+struct Background {
+  Background() {
+    Draw._Data = ImGui::GetDrawListSharedData();
+    Draw._ResetForNewFrame();
+    Draw.PushTextureID( ImGui::GetIO().Fonts->TexID );
+    Draw.PushClipRectFullScreen();
+    Shapes.Clear();
+    Offscreen.NewFrame();
+    Target = &Draw;
+    TargetShapes = &Shapes;
+    Emitted = 0;
+    Culled = 0;
   };
 
   ~Background() {
-    ImGui::FindWindowByName( "##Background" )->DrawList->PushClipRectFullScreen();
-    ImGui::End();
+    Shapes.Flush( &Draw );
   };
 };
 
 inline void DrawLuaBindings( sol::table &draw ) {
   //  line                     (const ImVec2& p1, const ImVec2& p2, ImU32 col, float thickness = 1.0f);
   draw.set_function( "line", []( int x, int y, int xx, int yy, uint32_t color, float thick ) {
-    Draw->AddLine( ImVec2( x, y ), ImVec2( xx, yy ), __builtin_bswap32( color ), thick );
+    if( !Visible( { ImVec2( x, y ), ImVec2( xx, yy ) }, Margin( thick ) ) ) {
+      return;
+    }
+
+    TargetShapes->Line( ImVec2( x, y ), ImVec2( xx, yy ), __builtin_bswap32( color ), thick );
   } );
   //  rect                     (const ImVec2& p_min, const ImVec2& p_max, ImU32 col, float rounding = 0.0f, ImDrawCornerFlags rounding_corners = ImDrawCornerFlags_All, float thickness = 1.0f);
   draw.set_function( "rect", []( int x, int y, int w, int h, uint32_t color, float thick ) {
-    Draw->AddRect( ImVec2( x, y ), ImVec2( x + w, y + h ), __builtin_bswap32( color ), 0, 0, thick );
+    if( !Visible( { ImVec2( x, y ), ImVec2( x + w, y + h ) }, Margin( thick ) ) ) {
+      return;
+    }
+
+    // A thickness of 0 fills the rectangle, rect() always outlines it like AddRect() did
+    TargetShapes->Rect( ImVec2( x, y ), ImVec2( x + w, y + h ), __builtin_bswap32( color ), ImMax( thick, 1.0f ) );
   } );
   //  rectfill                 (const ImVec2& p_min, const ImVec2& p_max, ImU32 col, float rounding = 0.0f, ImDrawCornerFlags rounding_corners = ImDrawCornerFlags_All);
-  draw.set_function( "rectfill", []( int x, int y, int w, int h, uint32_t color, float thick ) {
-    Draw->AddRect( ImVec2( x, y ), ImVec2( x + w, y + h ), __builtin_bswap32( color ), 0, 0, thick );
+  draw.set_function( "rectfill", []( int x, int y, int w, int h, uint32_t color ) {
+    if( !Visible( { ImVec2( x, y ), ImVec2( x + w, y + h ) }, 1.0f ) ) {
+      return;
+    }
+
+    TargetShapes->Rect( ImVec2( x, y ), ImVec2( x + w, y + h ), __builtin_bswap32( color ) );
   } );
   //  rectfilledmulticolor     (const ImVec2& p_min, const ImVec2& p_max, ImU32 col_upr_left, ImU32 col_upr_right, ImU32 col_bot_right, ImU32 col_bot_left);
   draw.set_function( "rectfillgradient", []( int x, int y, int w, int h, uint32_t color1, uint32_t color2, uint32_t color3, uint32_t color4 ) {
-    Draw->AddRectFilledMultiColor( ImVec2( x, y ), ImVec2( x + w, y + h ), __builtin_bswap32( color1 ), __builtin_bswap32( color2 ), __builtin_bswap32( color3 ), __builtin_bswap32( color4 ) );
+    if( !Visible( { ImVec2( x, y ), ImVec2( x + w, y + h ) }, 1.0f ) ) {
+      return;
+    }
+
+    Canvas()->AddRectFilledMultiColor( ImVec2( x, y ), ImVec2( x + w, y + h ), __builtin_bswap32( color1 ), __builtin_bswap32( color2 ), __builtin_bswap32( color3 ), __builtin_bswap32( color4 ) );
   } );
   //  quad                     (const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const ImVec2& p4, ImU32 col, float thickness = 1.0f);
   draw.set_function( "quad", []( int x1, int y1, int x2, int y2, int x3, int y3, int x4, int y4, uint32_t color, float thick ) {
-    Draw->AddQuad( ImVec2( x1, y1 ), ImVec2( x2, y2 ), ImVec2( x3, y3 ), ImVec2( x4, y4 ), __builtin_bswap32( color ), thick );
+    if( !Visible( { ImVec2( x1, y1 ), ImVec2( x2, y2 ), ImVec2( x3, y3 ), ImVec2( x4, y4 ) }, Margin( thick ) ) ) {
+      return;
+    }
+
+    Canvas()->AddQuad( ImVec2( x1, y1 ), ImVec2( x2, y2 ), ImVec2( x3, y3 ), ImVec2( x4, y4 ), __builtin_bswap32( color ), thick );
   } );
   //  quadfill                 (const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const ImVec2& p4, ImU32 col);
   draw.set_function( "quadfill", []( int x1, int y1, int x2, int y2, int x3, int y3, int x4, int y4, uint32_t color ) {
-    Draw->AddQuadFilled( ImVec2( x1, y1 ), ImVec2( x2, y2 ), ImVec2( x3, y3 ), ImVec2( x4, y4 ), __builtin_bswap32( color ) );
+    if( !Visible( { ImVec2( x1, y1 ), ImVec2( x2, y2 ), ImVec2( x3, y3 ), ImVec2( x4, y4 ) }, 1.0f ) ) {
+      return;
+    }
+
+    Canvas()->AddQuadFilled( ImVec2( x1, y1 ), ImVec2( x2, y2 ), ImVec2( x3, y3 ), ImVec2( x4, y4 ), __builtin_bswap32( color ) );
   } );
   //  triangle                 (const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, ImU32 col, float thickness = 1.0f);
   draw.set_function( "triangle", []( int x1, int y1, int x2, int y2, int x3, int y3, uint32_t color, float thick ) {
-    Draw->AddTriangle( ImVec2( x1, y1 ), ImVec2( x2, y2 ), ImVec2( x3, y3 ), __builtin_bswap32( color ), thick );
+    if( !Visible( { ImVec2( x1, y1 ), ImVec2( x2, y2 ), ImVec2( x3, y3 ) }, Margin( thick ) ) ) {
+      return;
+    }
+
+    Canvas()->AddTriangle( ImVec2( x1, y1 ), ImVec2( x2, y2 ), ImVec2( x3, y3 ), __builtin_bswap32( color ), thick );
   } );
   //  trianglefill             (const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, ImU32 col);
   draw.set_function( "trianglefill", []( int x1, int y1, int x2, int y2, int x3, int y3, uint32_t color ) {
-    Draw->AddTriangleFilled( ImVec2( x1, y1 ), ImVec2( x2, y2 ), ImVec2( x3, y3 ), __builtin_bswap32( color ) );
+    if( !Visible( { ImVec2( x1, y1 ), ImVec2( x2, y2 ), ImVec2( x3, y3 ) }, 1.0f ) ) {
+      return;
+    }
+
+    Canvas()->AddTriangleFilled( ImVec2( x1, y1 ), ImVec2( x2, y2 ), ImVec2( x3, y3 ), __builtin_bswap32( color ) );
   } );
   //  circle                   (const ImVec2& center, float radius, ImU32 col, int num_segments = 0, float thickness = 1.0f);
   draw.set_function( "circle", []( int cx, int cy, float radius, uint32_t color, float thickness ) {
-    Draw->AddCircle( ImVec2( cx, cy ), radius, __builtin_bswap32( color ), 0, thickness );
+    if( !Visible( { ImVec2( cx - radius, cy - radius ), ImVec2( cx + radius, cy + radius ) }, Margin( thickness ) ) ) {
+      return;
+    }
+
+    // Same as rect(), only circlefill() fills
+    TargetShapes->Circle( ImVec2( cx, cy ), radius, __builtin_bswap32( color ), ImMax( thickness, 1.0f ) );
   } );
   //  circlefill               (const ImVec2& center, float radius, ImU32 col, int num_segments = 0);
   draw.set_function( "circlefill", []( int cx, int cy, float radius, uint32_t color ) {
-    Draw->AddCircleFilled( ImVec2( cx, cy ), radius, __builtin_bswap32( color ), 0 );
+    if( !Visible( { ImVec2( cx - radius, cy - radius ), ImVec2( cx + radius, cy + radius ) }, 1.0f ) ) {
+      return;
+    }
+
+    TargetShapes->Circle( ImVec2( cx, cy ), radius, __builtin_bswap32( color ) );
   } );
   //  ngon                     (const ImVec2& center, float radius, ImU32 col, int num_segments, float thickness = 1.0f);
   draw.set_function( "ngon", []( int cx, int cy, float radius, uint32_t color, int segments, float thickness ) {
-    Draw->AddNgon( ImVec2( cx, cy ), radius, __builtin_bswap32( color ), segments, thickness );
+    if( !Visible( { ImVec2( cx - radius, cy - radius ), ImVec2( cx + radius, cy + radius ) }, Margin( thickness ) ) ) {
+      return;
+    }
+
+    Canvas()->AddNgon( ImVec2( cx, cy ), radius, __builtin_bswap32( color ), segments, thickness );
   } );
   //  ngonfill                 (const ImVec2& center, float radius, ImU32 col, int num_segments);
   draw.set_function( "ngonfill", []( int cx, int cy, float radius, uint32_t color, int segments ) {
-    Draw->AddNgon( ImVec2( cx, cy ), radius, __builtin_bswap32( color ), segments );
+    if( !Visible( { ImVec2( cx - radius, cy - radius ), ImVec2( cx + radius, cy + radius ) }, 1.0f ) ) {
+      return;
+    }
+
+    Canvas()->AddNgon( ImVec2( cx, cy ), radius, __builtin_bswap32( color ), segments );
   } );
   //  text                     (const ImVec2& pos, ImU32 col, const char* text_begin, const char* text_end = NULL);
-  draw.set_function( "text", []( int x, int y, uint32_t color, std::string text ) {
-    Draw->AddText( ImVec2( x, y ), __builtin_bswap32( color ), text.c_str() );
+  //  the view points into the Lua string, which outlives the call, so nothing is copied
+  draw.set_function( "text", []( int x, int y, uint32_t color, std::string_view text ) {
+    // Only runs to the right and down, how far right isn't known without measuring
+    float height = ( std::count( text.begin(), text.end(), '\n' ) + 1 ) * ImGui::GetFontSize();
+
+    if( !Visible( { ImVec2( x, y ), ImVec2( FLT_MAX, y + height ) }, 0.0f ) ) {
+      return;
+    }
+
+    Canvas()->AddText( ImVec2( x, y ), __builtin_bswap32( color ), text.data(), text.data() + text.size() );
   } );
   //  beziercurve              (const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const ImVec2& p4, ImU32 col, float thickness, int num_segments = 0);
   draw.set_function( "beziercurve", []( int x1, int y1, int x2, int y2, int x3, int y3, int x4, int y4, uint32_t color, float thick ) {
-    Draw->AddBezierCurve( ImVec2( x1, y1 ), ImVec2( x2, y2 ), ImVec2( x3, y3 ), ImVec2( x4, y4 ), __builtin_bswap32( color ), thick, 0 );
+    if( !Visible( { ImVec2( x1, y1 ), ImVec2( x2, y2 ), ImVec2( x3, y3 ), ImVec2( x4, y4 ) }, Margin( thick ) ) ) {
+      return;
+    }
+
+    Canvas()->AddBezierCurve( ImVec2( x1, y1 ), ImVec2( x2, y2 ), ImVec2( x3, y3 ), ImVec2( x4, y4 ), __builtin_bswap32( color ), thick, 0 );
+  } );
+
+  //  image                    loads width x height pixels under name, as a string of RGBA bytes or a table of colors, returns the id for draw.sprite()
+  draw.set_function( "image", sol::overload(
+  []( std::string_view name, int width, int height, std::string_view pixels ) {
+    if( width <= 0 || height <= 0 || pixels.size() != ( size_t )width * height * 4 ) {
+      throw sol::error( "draw.image: expected width * height * 4 bytes of pixels" );
+    }
+
+    int id = Images.Load( name, width, height, reinterpret_cast<const ImU32 *>( pixels.data() ) );
+
+    if( id < 0 ) {
+      throw sol::error( "draw.image: the image is too large for a texture" );
+    }
+
+    return id;
+  },
+  []( std::string_view name, int width, int height, const sol::table & pixels ) {
+    if( width <= 0 || height <= 0 || pixels.size() != ( size_t )width * height ) {
+      throw sol::error( "draw.image: expected width * height colors" );
+    }
+
+    ImU32 *colors = Site::FrameAlloc<ImU32>( pixels.size() );
+
+    for( size_t i = 0; i < pixels.size(); ++i ) {
+      colors[i] = __builtin_bswap32( pixels.raw_get<uint32_t>( i + 1 ) );
+    }
+
+    int id = Images.Load( name, width, height, colors );
+
+    if( id < 0 ) {
+      throw sol::error( "draw.image: the image is too large for a texture" );
+    }
+
+    return id;
+  } ) );
+  //  sprite                   (ImTextureID user_texture_id, const ImVec2& p_min, const ImVec2& p_max, const ImVec2& uv_min, const ImVec2& uv_max, ImU32 col = IM_COL32_WHITE);
+  //  sprites of the same atlas drawn one after the other share a draw command
+  draw.set_function( "sprite", []( int id, int x, int y, sol::optional<int> w, sol::optional<int> h, sol::optional<uint32_t> color ) {
+    ImVec2 size = Images.GetSize( id );
+
+    if( size.x == 0.0f ) {
+      throw sol::error( "draw.sprite: no image with that id" );
+    }
+
+    ImVec2 min( x, y );
+    ImVec2 max( x + w.value_or( size.x ), y + h.value_or( size.y ) );
+
+    if( !Visible( { min, max }, 0.0f ) ) {
+      return;
+    }
+
+    Images.Draw( Canvas(), id, min, max, color ? __builtin_bswap32( *color ) : IM_COL32_WHITE );
   } );
 
+  //  layer                    draws body into a layer kept across frames, only when the layer was invalidated
+  draw.set_function( "layer", []( std::string_view name, sol::protected_function body ) {
+    if( Target != &Draw ) {
+      throw sol::error( "draw.layer: layers can't be nested" );
+    }
+
+    if( Offscreen.Begin( name ) ) {
+      Target = Offscreen.GetDrawList();
+      TargetShapes = Offscreen.GetShapes();
+      sol::protected_function_result result = body();
+      Target = &Draw;
+      TargetShapes = &Shapes;
+      Offscreen.End();
+
+      if( !result.valid() ) {
+        Offscreen.Invalidate( name );
+        sol::error error = result;
+        throw error;
+      }
+    }
+
+    Offscreen.Composite( Canvas() );
+  } );
+  //  invalidate               draws the layer named, or every layer, again the next time it's shown
+  draw.set_function( "invalidate", sol::overload(
+  []( std::string_view name ) {
+    Offscreen.Invalidate( name );
+  },
+  []( ) {
+    Offscreen.InvalidateAll();
+  } ) );
+  //  layers_cached            keeps layers as vertices instead of textures, as without render targets, or tells if they are
+  draw.set_function( "layers_cached", sol::overload(
+  []( bool cached ) {
+    Offscreen.SetVertexCached( cached );
+  },
+  []( ) {
+    return Offscreen.IsVertexCached();
+  } ) );
+
+  //  stats                    shapes drawn and culled for being out of sight so far this frame
+  draw.set_function( "stats", []( ) {
+    return std::make_tuple( Emitted, Culled );
+  } );
 
   draw.set_function( "size", []( ) {
     int width, height;
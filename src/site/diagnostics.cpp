@@ -0,0 +1,205 @@
+#include "diagnostics.h"
+
+#include <cstdlib>
+
+#include "../lua/lua.h"
+#include "../lua/lauxlib.h"
+#include "../lua/ldo.h"
+#include "../lua/lzio.h"
+
+namespace Site {
+
+  struct SourceReader {
+    const std::string *mText;
+    bool mRead;
+    bool mEnd;
+  };
+
+  // Hands the whole text over as a single block, so the stream position tells
+  // exactly where in the text the lexer stopped
+  static const char *ReadSource( lua_State *, void *aData, size_t *aSize ) {
+    auto reader = static_cast<SourceReader *>( aData );
+
+    if( reader->mRead ) {
+      reader->mEnd = true;
+      *aSize = 0;
+      return nullptr;
+    }
+
+    reader->mRead = true;
+    *aSize = reader->mText->size();
+    return reader->mText->data();
+  }
+
+  std::vector<Diagnostic> CheckSyntax( lua_State *L, const std::string &aText ) {
+    std::vector<Diagnostic> diagnostics;
+
+    SourceReader reader = { &aText, false, false };
+    ZIO z;
+    luaZ_init( L, &z, ReadSource, &reader );
+
+    // Same as lua_load() minus the closure setup, we keep the stream to inspect it
+    // "=" makes the chunk name empty, so messages are prefixed by ":line: " only
+    if( luaD_protectedparser( L, &z, "=", "t" ) != LUA_OK ) {
+      const char *error = lua_tostring( L, -1 );
+      std::string message = error != nullptr ? error : "unknown error";
+
+      // The prefix holds the lexer's line number, ":line: " since the chunk name is empty
+      int line = 1;
+      size_t digits = message.find_first_not_of( "0123456789", 1 );
+
+      if( message.size() > 1 && message[0] == ':' && digits != 1 && digits != std::string::npos &&
+          message.compare( digits, 2, ": " ) == 0 ) {
+        line = std::atoi( message.c_str() + 1 );
+        message.erase( 0, digits + 2 );
+      }
+
+      // The lexer always reads one character past the token it failed on
+      size_t tokenEnd = aText.size();
+
+      if( !reader.mEnd && z.p != nullptr ) {
+        tokenEnd = ( size_t )( z.p - aText.data() ) - 1;
+      }
+
+      // Messages end with "near 'token'", or "near <eof>" when the text ran out
+      size_t tokenStart = tokenEnd;
+      size_t near = message.rfind( " near '" );
+
+      if( near != std::string::npos && message.back() == '\'' ) {
+        std::string token = message.substr( near + 7, message.size() - near - 8 );
+
+        if( token.size() <= tokenEnd && aText.compare( tokenEnd - token.size(), token.size(), token ) == 0 ) {
+          tokenStart = tokenEnd - token.size();
+        }
+      }
+
+      size_t lineStart = 0;
+
+      for( int i = 1; i < line; ++i ) {
+        size_t next = aText.find( '\n', lineStart );
+
+        if( next == std::string::npos ) {
+          break;
+        }
+
+        lineStart = next + 1;
+      }
+
+      int column = tokenStart >= lineStart ? ( int )( tokenStart - lineStart ) + 1 : 1;
+      diagnostics.push_back( { line, column, message } );
+    }
+
+    lua_settop( L, 0 );
+
+    return diagnostics;
+  }
+
+  Diagnostics::Diagnostics( double aDelay )
+    : mDelay( aDelay )
+    , mSubmitTime( 0.0 )
+    , mPending( false )
+    , mState( luaL_newstate() )
+#ifdef SITE_DIAGNOSTICS_THREADED
+    , mBusy( false )
+    , mDone( false )
+    , mQuit( false )
+#endif
+  {
+#ifdef SITE_DIAGNOSTICS_THREADED
+    mThread = std::thread( &Diagnostics::Worker, this );
+#endif
+  }
+
+  Diagnostics::~Diagnostics() {
+#ifdef SITE_DIAGNOSTICS_THREADED
+    {
+      std::lock_guard<std::mutex> lock( mMutex );
+      mQuit = true;
+    }
+    mWake.notify_one();
+    mThread.join();
+#endif
+    lua_close( mState );
+  }
+
+  void Diagnostics::Submit( const std::string &aText, double aTime ) {
+#ifdef SITE_DIAGNOSTICS_THREADED
+    std::lock_guard<std::mutex> lock( mMutex );
+#endif
+    mPendingText = aText;
+    mSubmitTime = aTime;
+    mPending = true;
+  }
+
+  bool Diagnostics::IsPending() {
+#ifdef SITE_DIAGNOSTICS_THREADED
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mPending || mBusy || mDone;
+#else
+    return mPending;
+#endif
+  }
+
+#ifdef SITE_DIAGNOSTICS_THREADED
+
+  bool Diagnostics::Poll( double aTime, std::string &aText, std::vector<Diagnostic> &aDiagnostics ) {
+    std::lock_guard<std::mutex> lock( mMutex );
+    bool finished = false;
+
+    if( mDone ) {
+      aText = std::move( mJob );
+      aDiagnostics = std::move( mResult );
+      mDone = false;
+      mBusy = false;
+      finished = true;
+    }
+
+    if( mPending && !mBusy && aTime - mSubmitTime >= mDelay ) {
+      mJob = std::move( mPendingText );
+      mPending = false;
+      mBusy = true;
+      mWake.notify_one();
+    }
+
+    return finished;
+  }
+
+  // mJob is only touched by the worker while mBusy is set and mDone isn't
+  void Diagnostics::Worker() {
+    std::unique_lock<std::mutex> lock( mMutex );
+
+    while( true ) {
+      mWake.wait( lock, [this] {
+        return mQuit || ( mBusy && !mDone );
+      } );
+
+      if( mQuit ) {
+        return;
+      }
+
+      lock.unlock();
+      auto result = CheckSyntax( mState, mJob );
+      lock.lock();
+
+      mResult = std::move( result );
+      mDone = true;
+    }
+  }
+
+#else
+
+  bool Diagnostics::Poll( double aTime, std::string &aText, std::vector<Diagnostic> &aDiagnostics ) {
+    if( !mPending || aTime - mSubmitTime < mDelay ) {
+      return false;
+    }
+
+    aDiagnostics = CheckSyntax( mState, mPendingText );
+    aText = std::move( mPendingText );
+    mPending = false;
+
+    return true;
+  }
+
+#endif
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#if !defined( __EMSCRIPTEN__ ) || defined( __EMSCRIPTEN_PTHREADS__ )
+#define SITE_DIAGNOSTICS_THREADED
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+struct lua_State;
+
+namespace Site {
+
+  // A syntax error as reported by the Lua lexer/parser, line and column are 1 based
+  struct Diagnostic {
+    int mLine;
+    int mColumn;
+    std::string mMessage;
+  };
+
+  // Parses aText with the real Lua parser without running it
+  std::vector<Diagnostic> CheckSyntax( lua_State *L, const std::string &aText );
+
+  // Debounced syntax checker, a snapshot handed to Submit() is only parsed once
+  // no newer one arrived for mDelay seconds. With threads available the parse
+  // runs on a worker, otherwise it runs inside Poll().
+  class Diagnostics {
+   public:
+    Diagnostics( double aDelay = 0.3 );
+    ~Diagnostics();
+
+    void Submit( const std::string &aText, double aTime );
+
+    // Returns true once per finished check, with the text that was checked
+    bool Poll( double aTime, std::string &aText, std::vector<Diagnostic> &aDiagnostics );
+
+    // True while a submitted snapshot hasn't come out of Poll() yet
+    bool IsPending();
+
+   private:
+    double mDelay;
+    double mSubmitTime;
+    bool mPending;
+    std::string mPendingText;
+    lua_State *mState;
+
+#ifdef SITE_DIAGNOSTICS_THREADED
+    void Worker();
+
+    std::thread mThread;
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    bool mBusy;
+    bool mDone;
+    bool mQuit;
+    std::string mJob;
+    std::vector<Diagnostic> mResult;
+#endif
+  };
+
+}
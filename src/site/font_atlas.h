@@ -0,0 +1,9 @@
+#pragma once
+
+namespace Site {
+
+  // Default font atlas baked at build time, loaded with ImFontAtlasBuildLoadBaked()
+  extern const unsigned char FontAtlasBlob[];
+  extern const unsigned int FontAtlasBlobSize;
+
+}
@@ -0,0 +1,314 @@
+#include "layers.h"
+
+#include "../imgui/imgui_impl_opengl3.h"
+#include "../imgui/imgui_internal.h"
+
+#include <GLES2/gl2.h>
+#include <cstdio>
+#include <cstring>
+#include <tuple>
+
+namespace Site {
+
+  // Layer textures hold premultiplied alpha, see ImGui_ImplOpenGL3_SetPremultipliedTarget()
+  static void PremultipliedBlend( const ImDrawList *, const ImDrawCmd * ) {
+    glBlendFunc( GL_ONE, GL_ONE_MINUS_SRC_ALPHA );
+  }
+
+  Layers::Layer::Layer()
+    : mDrawList( nullptr )
+    , mDirty( true )
+    , mShown( false )
+    , mVersion( 0 )
+    , mRendered( 0 )
+    , mChunked( 0 )
+    , mWidth( 0 )
+    , mHeight( 0 )
+    , mTexture( 0 )
+    , mFramebuffer( 0 ) {
+    // Drawn once, so the shapes might as well be vertices
+    mShapes.SetTessellated( true );
+  }
+
+  Layers::Layers()
+    : mCurrent( nullptr )
+    , mDisplaySize( 0.0f, 0.0f )
+    , mVertexCached( false )
+    , mDevice( Device::None ) {
+  }
+
+  void Layers::NewFrame() {
+    ImGuiIO &io = ImGui::GetIO();
+    ImVec2 size( io.DisplaySize.x * io.DisplayFramebufferScale.x, io.DisplaySize.y * io.DisplayFramebufferScale.y );
+    bool resized = size.x != mDisplaySize.x || size.y != mDisplaySize.y;
+    mDisplaySize = size;
+    mCurrent = nullptr;
+
+    for( auto layer = mLayers.begin(); layer != mLayers.end(); ) {
+      if( !layer->second.mShown ) {
+        DestroyTarget( layer->second );
+        layer = mLayers.erase( layer );
+        continue;
+      }
+
+      layer->second.mShown = false;
+      layer->second.mDirty |= resized;
+      ++layer;
+    }
+  }
+
+  bool Layers::Begin( std::string_view aName ) {
+    auto layer = mLayers.find( aName );
+
+    if( layer == mLayers.end() ) {
+      layer = mLayers.emplace( std::piecewise_construct, std::forward_as_tuple( aName ), std::forward_as_tuple() ).first;
+    }
+
+    mCurrent = &layer->second;
+    mCurrent->mShown = true;
+
+    if( !mCurrent->mDirty ) {
+      return false;
+    }
+
+    // Set up the way the canvas is
+    ImDrawList &drawList = mCurrent->mDrawList;
+    drawList._Data = ImGui::GetDrawListSharedData();
+    drawList._ResetForNewFrame();
+    drawList.PushTextureID( ImGui::GetIO().Fonts->TexID );
+    drawList.PushClipRectFullScreen();
+    mCurrent->mShapes.Clear();
+
+    return true;
+  }
+
+  void Layers::End() {
+    mCurrent->mShapes.Flush( &mCurrent->mDrawList );
+    mCurrent->mDrawList._PopUnusedDrawCmd();
+    mCurrent->mDirty = false;
+    ++mCurrent->mVersion;
+  }
+
+  ImDrawList *Layers::GetDrawList() {
+    return &mCurrent->mDrawList;
+  }
+
+  Primitives *Layers::GetShapes() {
+    return &mCurrent->mShapes;
+  }
+
+  void Layers::Composite( ImDrawList *aCanvas ) {
+    Layer &layer = *mCurrent;
+    int width = ( int )mDisplaySize.x;
+    int height = ( int )mDisplaySize.y;
+
+    if( width <= 0 || height <= 0 ) {
+      return;
+    }
+
+    if( !IsVertexCached() && ( layer.mWidth != width || layer.mHeight != height ) ) {
+      mDevice = CreateTarget( layer, width, height ) ? Device::Ready : Device::Failed;
+    }
+
+    if( !IsVertexCached() ) {
+      aCanvas->AddCallback( PremultipliedBlend, nullptr );
+      aCanvas->AddImage( ( ImTextureID )( intptr_t )layer.mTexture, ImVec2( 0.0f, 0.0f ), ImGui::GetIO().DisplaySize, ImVec2( 0.0f, 1.0f ), ImVec2( 1.0f, 0.0f ) );
+      aCanvas->AddCallback( ImDrawCallback_ResetRenderState, nullptr );
+      return;
+    }
+
+    if( layer.mChunked != layer.mVersion ) {
+      BuildChunks( layer );
+    }
+
+    for( const Chunk &chunk : layer.mChunks ) {
+      if( chunk.mCallback != nullptr ) {
+        aCanvas->AddCallback( chunk.mCallback, chunk.mCallbackData );
+        continue;
+      }
+
+      aCanvas->PushClipRect( ImVec2( chunk.mClipRect.x, chunk.mClipRect.y ), ImVec2( chunk.mClipRect.z, chunk.mClipRect.w ) );
+      aCanvas->PushTextureID( chunk.mTextureId );
+      aCanvas->PrimReserve( chunk.mIdxCount, chunk.mVtxCount );
+
+      // After PrimReserve(), which may have started a new block of vertices
+      ImDrawIdx base = ( ImDrawIdx )aCanvas->_VtxCurrentIdx;
+      const ImDrawIdx *index = &layer.mIndices[chunk.mIdxBegin];
+
+      memcpy( aCanvas->_VtxWritePtr, &layer.mVertices[chunk.mVtxBegin], chunk.mVtxCount * sizeof( ImDrawVert ) );
+
+      for( int i = 0; i < chunk.mIdxCount; ++i ) {
+        aCanvas->_IdxWritePtr[i] = ( ImDrawIdx )( base + index[i] );
+      }
+
+      aCanvas->_VtxWritePtr += chunk.mVtxCount;
+      aCanvas->_IdxWritePtr += chunk.mIdxCount;
+      aCanvas->_VtxCurrentIdx += chunk.mVtxCount;
+      aCanvas->PopTextureID();
+      aCanvas->PopClipRect();
+    }
+  }
+
+  void Layers::Invalidate( std::string_view aName ) {
+    auto layer = mLayers.find( aName );
+
+    if( layer != mLayers.end() ) {
+      layer->second.mDirty = true;
+    }
+  }
+
+  void Layers::InvalidateAll() {
+    for( auto &layer : mLayers ) {
+      layer.second.mDirty = true;
+    }
+  }
+
+  void Layers::Render() {
+    if( IsVertexCached() ) {
+      return;
+    }
+
+    GLint lastFramebuffer = 0;
+    bool bound = false;
+    ImGuiIO &io = ImGui::GetIO();
+
+    for( auto &entry : mLayers ) {
+      Layer &layer = entry.second;
+
+      if( layer.mFramebuffer == 0 || layer.mRendered == layer.mVersion ) {
+        continue;
+      }
+
+      if( !bound ) {
+        glGetIntegerv( GL_FRAMEBUFFER_BINDING, &lastFramebuffer );
+        ImGui_ImplOpenGL3_SetPremultipliedTarget( true );
+        bound = true;
+      }
+
+      glBindFramebuffer( GL_FRAMEBUFFER, layer.mFramebuffer );
+      glDisable( GL_SCISSOR_TEST );
+      glViewport( 0, 0, layer.mWidth, layer.mHeight );
+      glClearColor( 0.0f, 0.0f, 0.0f, 0.0f );
+      glClear( GL_COLOR_BUFFER_BIT );
+
+      ImDrawList *drawList = &layer.mDrawList;
+      ImDrawData drawData;
+      drawData.Valid = true;
+      drawData.CmdLists = &drawList;
+      drawData.CmdListsCount = 1;
+      drawData.TotalVtxCount = drawList->VtxBuffer.Size;
+      drawData.TotalIdxCount = drawList->IdxBuffer.Size;
+      drawData.DisplayPos = ImVec2( 0.0f, 0.0f );
+      drawData.DisplaySize = io.DisplaySize;
+      drawData.FramebufferScale = io.DisplayFramebufferScale;
+      ImGui_ImplOpenGL3_RenderDrawData( &drawData );
+
+      layer.mRendered = layer.mVersion;
+    }
+
+    if( bound ) {
+      ImGui_ImplOpenGL3_SetPremultipliedTarget( false );
+      glBindFramebuffer( GL_FRAMEBUFFER, ( GLuint )lastFramebuffer );
+    }
+  }
+
+  uint32_t Layers::Hash( uint32_t aSeed ) const {
+    for( auto &layer : mLayers ) {
+      aSeed = ImHashData( &layer.second.mVersion, sizeof( layer.second.mVersion ), aSeed );
+    }
+
+    return aSeed;
+  }
+
+  // Every command gets its own copy of the vertices it uses, so it can be
+  // appended at any vertex index
+  void Layers::BuildChunks( Layer &aLayer ) const {
+    const ImDrawList &drawList = aLayer.mDrawList;
+    aLayer.mChunks.clear();
+    aLayer.mVertices.clear();
+    aLayer.mIndices.clear();
+
+    for( const ImDrawCmd &command : drawList.CmdBuffer ) {
+      Chunk chunk = { command.ClipRect, command.TextureId, command.UserCallback, command.UserCallbackData, ( int )aLayer.mVertices.size(), 0, ( int )aLayer.mIndices.size(), 0 };
+
+      if( command.UserCallback == nullptr ) {
+        if( command.ElemCount == 0 ) {
+          continue;
+        }
+
+        const ImDrawIdx *indices = drawList.IdxBuffer.Data + command.IdxOffset;
+        unsigned int first = indices[0], last = indices[0];
+
+        for( unsigned int i = 1; i < command.ElemCount; ++i ) {
+          first = ImMin( first, ( unsigned int )indices[i] );
+          last = ImMax( last, ( unsigned int )indices[i] );
+        }
+
+        const ImDrawVert *vertices = drawList.VtxBuffer.Data + command.VtxOffset;
+        aLayer.mVertices.insert( aLayer.mVertices.end(), vertices + first, vertices + last + 1 );
+
+        for( unsigned int i = 0; i < command.ElemCount; ++i ) {
+          aLayer.mIndices.push_back( ( ImDrawIdx )( indices[i] - first ) );
+        }
+
+        chunk.mVtxCount = ( int )( last - first + 1 );
+        chunk.mIdxCount = ( int )command.ElemCount;
+      }
+
+      aLayer.mChunks.push_back( chunk );
+    }
+
+    aLayer.mChunked = aLayer.mVersion;
+  }
+
+  bool Layers::CreateTarget( Layer &aLayer, int aWidth, int aHeight ) {
+    if( aLayer.mTexture == 0 ) {
+      glGenTextures( 1, &aLayer.mTexture );
+      glGenFramebuffers( 1, &aLayer.mFramebuffer );
+    }
+
+    GLint lastTexture, lastFramebuffer;
+    glGetIntegerv( GL_TEXTURE_BINDING_2D, &lastTexture );
+    glGetIntegerv( GL_FRAMEBUFFER_BINDING, &lastFramebuffer );
+
+    // Shown pixel for pixel, without mipmaps as they can be any size
+    glBindTexture( GL_TEXTURE_2D, aLayer.mTexture );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+    glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, aWidth, aHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr );
+
+    glBindFramebuffer( GL_FRAMEBUFFER, aLayer.mFramebuffer );
+    glFramebufferTexture2D( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, aLayer.mTexture, 0 );
+    GLenum status = glCheckFramebufferStatus( GL_FRAMEBUFFER );
+
+    glBindTexture( GL_TEXTURE_2D, ( GLuint )lastTexture );
+    glBindFramebuffer( GL_FRAMEBUFFER, ( GLuint )lastFramebuffer );
+
+    if( status != GL_FRAMEBUFFER_COMPLETE ) {
+      fprintf( stderr, "ERROR: Site::Layers: can't render into a %dx%d texture, keeping vertices instead!\n", aWidth, aHeight );
+      DestroyTarget( aLayer );
+      return false;
+    }
+
+    aLayer.mWidth = aWidth;
+    aLayer.mHeight = aHeight;
+    aLayer.mRendered = aLayer.mVersion - 1;
+
+    return true;
+  }
+
+  void Layers::DestroyTarget( Layer &aLayer ) {
+    if( aLayer.mTexture != 0 ) {
+      glDeleteFramebuffers( 1, &aLayer.mFramebuffer );
+      glDeleteTextures( 1, &aLayer.mTexture );
+    }
+
+    aLayer.mTexture = 0;
+    aLayer.mFramebuffer = 0;
+    aLayer.mWidth = 0;
+    aLayer.mHeight = 0;
+  }
+
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../imgui/imgui.h"
+#include "primitives.h"
+
+namespace Site {
+
+  // Named layers the scripts draw once and show every frame. A layer is drawn
+  // again only when it's invalidated or the display changes size, and is
+  // rendered into a texture composited with a single quad. Without render
+  // targets its vertices are kept instead and appended to the canvas.
+  class Layers {
+   public:
+    Layers();
+
+    // Drops the layers that weren't shown since the last call, and invalidates
+    // the others when the display changed size
+    void NewFrame();
+
+    // Starts showing aName, returns true when it has to be drawn first, into
+    // GetDrawList() and GetShapes() until End()
+    bool Begin( std::string_view aName );
+    void End();
+
+    ImDrawList *GetDrawList();
+    Primitives *GetShapes();
+
+    // Appends the layer of the last Begin() to aCanvas
+    void Composite( ImDrawList *aCanvas );
+
+    void Invalidate( std::string_view aName );
+    void InvalidateAll();
+
+    // Renders the layers drawn since the last call into their textures, before the frame is drawn
+    void Render();
+
+    // Folds the layers' versions into aSeed, the composited quads don't change with them
+    uint32_t Hash( uint32_t aSeed ) const;
+
+    // Keeps vertices instead of textures, also used when render targets can't be made.
+    // Switching redraws every layer, the other mode's texture or vertices are stale
+    inline void SetVertexCached( bool aValue ) {
+      if( aValue != mVertexCached ) {
+        mVertexCached = aValue;
+        InvalidateAll();
+      }
+    }
+
+    inline bool IsVertexCached() const {
+      return mVertexCached || mDevice == Device::Failed;
+    }
+
+   private:
+    enum class Device : uint8_t {
+      None,
+      Ready,
+      Failed
+    };
+
+    // Commands of a layer ready to append, indices start at the chunk's first vertex
+    struct Chunk {
+      ImVec4 mClipRect;
+      ImTextureID mTextureId;
+      ImDrawCallback mCallback;
+      void *mCallbackData;
+      int mVtxBegin, mVtxCount;
+      int mIdxBegin, mIdxCount;
+    };
+
+    struct Layer {
+      Layer();
+
+      ImDrawList mDrawList;
+      Primitives mShapes;
+      std::vector<Chunk> mChunks;
+      std::vector<ImDrawVert> mVertices;
+      std::vector<ImDrawIdx> mIndices;
+      bool mDirty;
+      bool mShown;
+      uint32_t mVersion;
+      uint32_t mRendered;     // version in the texture
+      uint32_t mChunked;      // version in mChunks
+      int mWidth, mHeight;    // of the texture, in framebuffer pixels
+      unsigned int mTexture;
+      unsigned int mFramebuffer;
+    };
+
+    void BuildChunks( Layer &aLayer ) const;
+    bool CreateTarget( Layer &aLayer, int aWidth, int aHeight );
+    void DestroyTarget( Layer &aLayer );
+
+    std::map<std::string, Layer, std::less<>> mLayers;
+    Layer *mCurrent;
+    ImVec2 mDisplaySize;
+    bool mVertexCached;
+    Device mDevice;
+  };
+
+}
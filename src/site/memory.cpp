@@ -0,0 +1,179 @@
+#include "memory.h"
+
+#include "../imgui/imgui.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+namespace Site {
+
+  // Blocks of 32 bytes to 4 KB, header included, each class twice the size of the one before
+  static const size_t MinClassShift = 5;
+  static const size_t ClassCount = 8;
+  static const uint32_t LargeClass = ClassCount;
+
+  // Pools and the arena grow by this much at a time
+  static const size_t ChunkSize = 64 * 1024;
+
+  // In front of every block, keeps the payload aligned the way malloc() does
+  struct alignas( std::max_align_t ) Header {
+    uint32_t mClass;
+  };
+
+  struct FreeBlock {
+    FreeBlock *mNext;
+  };
+
+  struct Pool {
+    FreeBlock *mFree;   // blocks given back
+    char *mNext;        // never handed out yet, up to mEnd
+    char *mEnd;
+  };
+
+  struct Arena {
+    char *mBlock;
+    size_t mCapacity;
+    size_t mUsed;
+    size_t mOverflow;   // bytes malloc()ed past mBlock this frame, folded into it at the next frame
+    std::vector<void *> mSpills;
+  };
+
+  static Pool Pools[ClassCount];
+  static Arena Scratch;
+  static MemoryStats Counting;
+  static MemoryStats Counted;
+
+  static size_t Align( size_t aSize ) {
+    return ( aSize + alignof( std::max_align_t ) - 1 ) & ~( alignof( std::max_align_t ) - 1 );
+  }
+
+  static void *SystemAlloc( size_t aSize ) {
+    ++Counting.mSystemAllocations;
+    return malloc( aSize );
+  }
+
+  // Smallest class holding aSize bytes, LargeClass when none does
+  static uint32_t ClassOf( size_t aSize ) {
+    uint32_t index = 0;
+
+    while( index < ClassCount && ( ( size_t )1 << ( index + MinClassShift ) ) < aSize ) {
+      ++index;
+    }
+
+    return index;
+  }
+
+  void *PoolAlloc( size_t aSize, void *aUserData ) {
+    IM_UNUSED( aUserData );
+    ++Counting.mAllocations;
+
+    size_t size = aSize + sizeof( Header );
+    uint32_t index = ClassOf( size );
+    Header *header;
+
+    if( index == LargeClass ) {
+      header = static_cast<Header *>( SystemAlloc( size ) );
+
+      if( header == nullptr ) {
+        return nullptr;
+      }
+    } else {
+      Pool &pool = Pools[index];
+      size_t blockSize = ( size_t )1 << ( index + MinClassShift );
+
+      if( pool.mFree != nullptr ) {
+        header = reinterpret_cast<Header *>( pool.mFree );
+        pool.mFree = pool.mFree->mNext;
+      } else {
+        if( pool.mNext == pool.mEnd ) {
+          pool.mNext = static_cast<char *>( SystemAlloc( ChunkSize ) );
+
+          if( pool.mNext == nullptr ) {
+            pool.mEnd = nullptr;
+            return nullptr;
+          }
+
+          pool.mEnd = pool.mNext + ChunkSize;
+          Counting.mPoolBytes += ChunkSize;
+        }
+
+        header = reinterpret_cast<Header *>( pool.mNext );
+        pool.mNext += blockSize;
+      }
+    }
+
+    header->mClass = index;
+    return header + 1;
+  }
+
+  void PoolFree( void *aPointer, void *aUserData ) {
+    IM_UNUSED( aUserData );
+
+    if( aPointer == nullptr ) {
+      return;
+    }
+
+    ++Counting.mFrees;
+
+    Header *header = static_cast<Header *>( aPointer ) - 1;
+    uint32_t index = header->mClass;
+    IM_ASSERT( index <= LargeClass );
+
+    if( index == LargeClass ) {
+      free( header );
+      return;
+    }
+
+    FreeBlock *block = reinterpret_cast<FreeBlock *>( header );
+    block->mNext = Pools[index].mFree;
+    Pools[index].mFree = block;
+  }
+
+  void *FrameAlloc( size_t aSize ) {
+    size_t size = Align( aSize );
+    Counting.mFrameBytes += size;
+
+    if( Scratch.mUsed + size <= Scratch.mCapacity ) {
+      void *pointer = Scratch.mBlock + Scratch.mUsed;
+      Scratch.mUsed += size;
+      return pointer;
+    }
+
+    // Too small this frame, the next one gets a block large enough for both
+    void *pointer = SystemAlloc( size );
+    Scratch.mSpills.push_back( pointer );
+    Scratch.mOverflow += size;
+    return pointer;
+  }
+
+  void NewMemoryFrame() {
+    for( void *spill : Scratch.mSpills ) {
+      free( spill );
+    }
+
+    Scratch.mSpills.clear();
+
+    if( Scratch.mOverflow > 0 ) {
+      size_t capacity = Scratch.mCapacity + std::max( Scratch.mOverflow, ChunkSize );
+      free( Scratch.mBlock );
+      Scratch.mBlock = static_cast<char *>( SystemAlloc( capacity ) );
+      Scratch.mCapacity = Scratch.mBlock != nullptr ? capacity : 0;
+      Scratch.mOverflow = 0;
+    }
+
+    Scratch.mUsed = 0;
+
+    Counted = Counting;
+    Counting.mAllocations = 0;
+    Counting.mFrees = 0;
+    Counting.mSystemAllocations = 0;
+    Counting.mFrameBytes = 0;
+  }
+
+  const MemoryStats &GetMemoryStats() {
+    return Counted;
+  }
+
+}
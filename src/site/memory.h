@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Site {
+
+  // Allocation counts of a frame, from NewMemoryFrame() to the next
+  struct MemoryStats {
+    int mAllocations;       // through PoolAlloc()
+    int mFrees;             // through PoolFree()
+    int mSystemAllocations; // calls to malloc(), for large blocks and to grow the pools or the arena
+    size_t mPoolBytes;      // held by the pools, they never give memory back
+    size_t mFrameBytes;     // handed out by FrameAlloc()
+  };
+
+  // Allocator for ImGui::SetAllocatorFunctions(). Blocks up to 4 KB come from
+  // size class pools and are recycled on free, larger ones from malloc().
+  // Like ImGui it's only used from the main thread.
+  void *PoolAlloc( size_t aSize, void *aUserData );
+  void PoolFree( void *aPointer, void *aUserData );
+
+  // Scratch memory that's valid until the next NewMemoryFrame(), never freed on its own
+  void *FrameAlloc( size_t aSize );
+
+  template<typename T>
+  inline T *FrameAlloc( size_t aCount ) {
+    return static_cast<T *>( FrameAlloc( aCount * sizeof( T ) ) );
+  }
+
+  // Starts a frame, the memory of FrameAlloc() is reused and the counters start over
+  void NewMemoryFrame();
+
+  // Counters of the last whole frame
+  const MemoryStats &GetMemoryStats();
+
+}
@@ -0,0 +1,440 @@
+#include "primitives.h"
+
+#include "../imgui/imgui_impl_opengl3.h"
+#include "../imgui/imgui_internal.h"
+
+#include <GLES2/gl2.h>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+
+namespace Site {
+
+  // A quad has 4 vertices, that many quads fit 16-bit indices
+  static const size_t MaxQuads = 65536 / 4;
+
+  // Every vertex of a quad carries the whole shape, in the space the shader works in
+  struct ShapeVertex {
+    ImVec2 mPosition;
+    ImVec2 mLocal;      // position relative to the shape's origin
+    ImVec2 mExtent;     // radius in x, size or line direction
+    ImVec2 mParams;     // thickness, kind
+    ImU32 mColor;
+  };
+
+  static std::vector<ShapeVertex> Vertices;
+
+  static const GLuint AttribPosition = 0, AttribLocal = 1, AttribExtent = 2, AttribParams = 3, AttribColor = 4;
+
+  static const GLchar *VertexShader =
+    "uniform mat4 ProjMtx;\n"
+    "attribute vec2 Position;\n"
+    "attribute vec2 Local;\n"
+    "attribute vec2 Extent;\n"
+    "attribute vec2 Params;\n"
+    "attribute vec4 Color;\n"
+    "varying vec2 Frag_Local;\n"
+    "varying vec2 Frag_Extent;\n"
+    "varying vec2 Frag_Params;\n"
+    "varying vec4 Frag_Color;\n"
+    "void main()\n"
+    "{\n"
+    "    Frag_Local = Local;\n"
+    "    Frag_Extent = Extent;\n"
+    "    Frag_Params = Params;\n"
+    "    Frag_Color = Color;\n"
+    "    gl_Position = ProjMtx * vec4(Position.xy,0,1);\n"
+    "}\n";
+
+  // Keep in sync with Distance() below
+  static const GLchar *FragmentShader =
+    "#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
+    "precision highp float;\n"
+    "#else\n"
+    "precision mediump float;\n"
+    "#endif\n"
+    "varying vec2 Frag_Local;\n"
+    "varying vec2 Frag_Extent;\n"
+    "varying vec2 Frag_Params;\n"
+    "varying vec4 Frag_Color;\n"
+    "float Box(vec2 q)\n"
+    "{\n"
+    "    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0);\n"
+    "}\n"
+    "void main()\n"
+    "{\n"
+    "    float thickness = Frag_Params.x;\n"
+    "    float d;\n"
+    "    if (Frag_Params.y < 0.5) {\n"
+    "        d = length(Frag_Local) - Frag_Extent.x;\n"
+    "    } else if (Frag_Params.y < 1.5) {\n"
+    "        vec2 size = Frag_Extent * 0.5;\n"
+    "        d = Box(abs(Frag_Local - size) - size);\n"
+    "    } else {\n"
+    "        float len = length(Frag_Extent);\n"
+    "        vec2 dir = len > 0.0 ? Frag_Extent / len : vec2(1.0, 0.0);\n"
+    "        float along = dot(Frag_Local, dir);\n"
+    "        float across = dot(Frag_Local, vec2(-dir.y, dir.x));\n"
+    "        d = Box(vec2(abs(along - len * 0.5) - len * 0.5, abs(across) - thickness * 0.5));\n"
+    "        thickness = 0.0;\n"
+    "    }\n"
+    "    if (thickness > 0.0)\n"
+    "        d = abs(d) - thickness * 0.5;\n"
+    "    gl_FragColor = vec4(Frag_Color.rgb, Frag_Color.a * clamp(0.5 - d, 0.0, 1.0));\n"
+    "}\n";
+
+  // Where the shape sits once drawn, the same offsets as ImDrawList which puts
+  // lines and rectangle outlines on pixel centers
+  static void Prepare( const Primitives::Shape &aShape, ImVec2 &aOrigin, ImVec2 &aExtent ) {
+    switch( aShape.mKind ) {
+      case Primitives::Kind::Circle:
+        aOrigin = aShape.mA;
+        aExtent = ImVec2( aShape.mB.x, 0.0f );
+        break;
+
+      case Primitives::Kind::Rect:
+        if( aShape.mThickness > 0.0f ) {
+          aOrigin = ImVec2( aShape.mA.x + 0.5f, aShape.mA.y + 0.5f );
+          aExtent = ImVec2( aShape.mB.x - aShape.mA.x - 1.0f, aShape.mB.y - aShape.mA.y - 1.0f );
+        } else {
+          aOrigin = aShape.mA;
+          aExtent = ImVec2( aShape.mB.x - aShape.mA.x, aShape.mB.y - aShape.mA.y );
+        }
+
+        break;
+
+      case Primitives::Kind::Line:
+        aOrigin = ImVec2( aShape.mA.x + 0.5f, aShape.mA.y + 0.5f );
+        aExtent = ImVec2( aShape.mB.x - aShape.mA.x, aShape.mB.y - aShape.mA.y );
+        break;
+    }
+  }
+
+  static float Box( float aX, float aY ) {
+    return std::sqrt( ImMax( aX, 0.0f ) * ImMax( aX, 0.0f ) + ImMax( aY, 0.0f ) * ImMax( aY, 0.0f ) ) + ImMin( ImMax( aX, aY ), 0.0f );
+  }
+
+  // Signed distance from aLocal to the shape, the fragment shader's math
+  static float Distance( Primitives::Kind aKind, const ImVec2 &aLocal, const ImVec2 &aExtent, float aThickness ) {
+    float d;
+
+    switch( aKind ) {
+      case Primitives::Kind::Circle:
+        d = std::sqrt( aLocal.x * aLocal.x + aLocal.y * aLocal.y ) - aExtent.x;
+        break;
+
+      case Primitives::Kind::Rect: {
+        ImVec2 size( aExtent.x * 0.5f, aExtent.y * 0.5f );
+        d = Box( std::fabs( aLocal.x - size.x ) - size.x, std::fabs( aLocal.y - size.y ) - size.y );
+        break;
+      }
+
+      default: {
+        float length = std::sqrt( aExtent.x * aExtent.x + aExtent.y * aExtent.y );
+        ImVec2 dir = length > 0.0f ? ImVec2( aExtent.x / length, aExtent.y / length ) : ImVec2( 1.0f, 0.0f );
+        float along = aLocal.x * dir.x + aLocal.y * dir.y;
+        float across = aLocal.y * dir.x - aLocal.x * dir.y;
+        d = Box( std::fabs( along - length * 0.5f ) - length * 0.5f, std::fabs( across ) - aThickness * 0.5f );
+        aThickness = 0.0f;
+        break;
+      }
+    }
+
+    if( aThickness > 0.0f ) {
+      d = std::fabs( d ) - aThickness * 0.5f;
+    }
+
+    return d;
+  }
+
+  // Corners of the quad covering the shape and its antialiased edge, in drawing order
+  static void Corners( const Primitives::Shape &aShape, const ImVec2 &aOrigin, const ImVec2 &aExtent, ImVec2 aCorners[4] ) {
+    float margin = 1.0f + ( aShape.mThickness > 0.0f ? aShape.mThickness * 0.5f : 0.0f );
+
+    if( aShape.mKind == Primitives::Kind::Line ) {
+      float length = std::sqrt( aExtent.x * aExtent.x + aExtent.y * aExtent.y );
+      ImVec2 dir = length > 0.0f ? ImVec2( aExtent.x / length, aExtent.y / length ) : ImVec2( 1.0f, 0.0f );
+      ImVec2 across( -dir.y * margin, dir.x * margin );
+      ImVec2 begin( aOrigin.x - dir.x, aOrigin.y - dir.y );
+      ImVec2 end( aOrigin.x + aExtent.x + dir.x, aOrigin.y + aExtent.y + dir.y );
+
+      aCorners[0] = ImVec2( begin.x - across.x, begin.y - across.y );
+      aCorners[1] = ImVec2( end.x - across.x, end.y - across.y );
+      aCorners[2] = ImVec2( end.x + across.x, end.y + across.y );
+      aCorners[3] = ImVec2( begin.x + across.x, begin.y + across.y );
+      return;
+    }
+
+    ImVec2 min, max;
+
+    if( aShape.mKind == Primitives::Kind::Circle ) {
+      min = ImVec2( aOrigin.x - aExtent.x - margin, aOrigin.y - aExtent.x - margin );
+      max = ImVec2( aOrigin.x + aExtent.x + margin, aOrigin.y + aExtent.x + margin );
+    } else {
+      min = ImVec2( aOrigin.x - margin, aOrigin.y - margin );
+      max = ImVec2( aOrigin.x + aExtent.x + margin, aOrigin.y + aExtent.y + margin );
+    }
+
+    aCorners[0] = min;
+    aCorners[1] = ImVec2( max.x, min.y );
+    aCorners[2] = max;
+    aCorners[3] = ImVec2( min.x, max.y );
+  }
+
+  Primitives::Primitives()
+    : mFlushed( 0 )
+    , mTessellated( false )
+    , mDevice( Device::None )
+    , mProgram( 0 )
+    , mVertexBuffer( 0 )
+    , mIndexBuffer( 0 )
+    , mVertexBufferSize( 0 )
+    , mProjection( -1 ) {
+  }
+
+  void Primitives::Clear() {
+    mShapes.clear();
+    mBatches.clear();
+    mFlushed = 0;
+  }
+
+  void Primitives::Circle( const ImVec2 &aCenter, float aRadius, ImU32 aColor, float aThickness ) {
+    mShapes.push_back( { aCenter, ImVec2( aRadius, 0.0f ), aThickness, aColor, Kind::Circle } );
+  }
+
+  void Primitives::Rect( const ImVec2 &aMin, const ImVec2 &aMax, ImU32 aColor, float aThickness ) {
+    mShapes.push_back( { aMin, aMax, aThickness, aColor, Kind::Rect } );
+  }
+
+  void Primitives::Line( const ImVec2 &aFrom, const ImVec2 &aTo, ImU32 aColor, float aThickness ) {
+    mShapes.push_back( { aFrom, aTo, aThickness, aColor, Kind::Line } );
+  }
+
+  void Primitives::Flush( ImDrawList *aDrawList ) {
+    if( mFlushed == mShapes.size() ) {
+      return;
+    }
+
+    if( mDevice == Device::None && !mTessellated ) {
+      mDevice = CreateDeviceObjects() ? Device::Ready : Device::Failed;
+    }
+
+    if( IsTessellated() ) {
+      Tessellate( aDrawList, mFlushed, mShapes.size() );
+    } else {
+      mBatches.push_back( { this, mFlushed, mShapes.size() } );
+      aDrawList->AddCallback( RenderCallback, &mBatches.back() );
+      aDrawList->AddCallback( ImDrawCallback_ResetRenderState, nullptr );
+    }
+
+    mFlushed = mShapes.size();
+  }
+
+  uint32_t Primitives::Hash( uint32_t aSeed ) const {
+    // Up to the kind only, the padding after it is left undefined
+    const size_t size = offsetof( Shape, mKind ) + sizeof( Kind );
+
+    for( const Shape &shape : mShapes ) {
+      aSeed = ImHashData( &shape, size, aSeed );
+    }
+
+    return aSeed;
+  }
+
+  float Primitives::Coverage( const Shape &aShape, const ImVec2 &aPoint ) {
+    ImVec2 origin, extent;
+    Prepare( aShape, origin, extent );
+
+    float d = Distance( aShape.mKind, ImVec2( aPoint.x - origin.x, aPoint.y - origin.y ), extent, aShape.mThickness );
+    return ImClamp( 0.5f - d, 0.0f, 1.0f );
+  }
+
+  void Primitives::RenderCallback( const ImDrawList *, const ImDrawCmd *aCommand ) {
+    auto batch = static_cast<const Batch *>( aCommand->UserCallbackData );
+    batch->mOwner->Render( *batch, aCommand );
+  }
+
+  static GLuint CompileShader( GLenum aType, const GLchar *aSource ) {
+    GLuint shader = glCreateShader( aType );
+    glShaderSource( shader, 1, &aSource, nullptr );
+    glCompileShader( shader );
+
+    GLint status = 0;
+    glGetShaderiv( shader, GL_COMPILE_STATUS, &status );
+
+    if( status == GL_FALSE ) {
+      fprintf( stderr, "ERROR: Site::Primitives: failed to compile %s shader!\n", aType == GL_VERTEX_SHADER ? "vertex" : "fragment" );
+      glDeleteShader( shader );
+      return 0;
+    }
+
+    return shader;
+  }
+
+  bool Primitives::CreateDeviceObjects() {
+    GLuint vertex = CompileShader( GL_VERTEX_SHADER, VertexShader );
+    GLuint fragment = CompileShader( GL_FRAGMENT_SHADER, FragmentShader );
+
+    if( vertex == 0 || fragment == 0 ) {
+      glDeleteShader( vertex );
+      glDeleteShader( fragment );
+      return false;
+    }
+
+    mProgram = glCreateProgram();
+    glAttachShader( mProgram, vertex );
+    glAttachShader( mProgram, fragment );
+    glBindAttribLocation( mProgram, AttribPosition, "Position" );
+    glBindAttribLocation( mProgram, AttribLocal, "Local" );
+    glBindAttribLocation( mProgram, AttribExtent, "Extent" );
+    glBindAttribLocation( mProgram, AttribParams, "Params" );
+    glBindAttribLocation( mProgram, AttribColor, "Color" );
+    glLinkProgram( mProgram );
+    glDeleteShader( vertex );
+    glDeleteShader( fragment );
+
+    GLint status = 0;
+    glGetProgramiv( mProgram, GL_LINK_STATUS, &status );
+
+    if( status == GL_FALSE ) {
+      fprintf( stderr, "ERROR: Site::Primitives: failed to link the shader program!\n" );
+      glDeleteProgram( mProgram );
+      mProgram = 0;
+      return false;
+    }
+
+    mProjection = glGetUniformLocation( mProgram, "ProjMtx" );
+
+    // Every quad uses the same indices, relative to its first vertex
+    std::vector<GLushort> indices( MaxQuads * 6 );
+
+    for( size_t quad = 0; quad < MaxQuads; ++quad ) {
+      GLushort first = ( GLushort )( quad * 4 );
+      GLushort *index = &indices[quad * 6];
+      index[0] = first;
+      index[1] = first + 1;
+      index[2] = first + 2;
+      index[3] = first;
+      index[4] = first + 2;
+      index[5] = first + 3;
+    }
+
+    GLint lastArrayBuffer, lastElementArrayBuffer;
+    glGetIntegerv( GL_ARRAY_BUFFER_BINDING, &lastArrayBuffer );
+    glGetIntegerv( GL_ELEMENT_ARRAY_BUFFER_BINDING, &lastElementArrayBuffer );
+    glGenBuffers( 1, &mVertexBuffer );
+    glGenBuffers( 1, &mIndexBuffer );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer );
+    glBufferData( GL_ELEMENT_ARRAY_BUFFER, ( GLsizeiptr )( indices.size() * sizeof( GLushort ) ), indices.data(), GL_STATIC_DRAW );
+    glBindBuffer( GL_ARRAY_BUFFER, ( GLuint )lastArrayBuffer );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, ( GLuint )lastElementArrayBuffer );
+
+    // Created while the script draws, outside of the renderer
+    ImGui_ImplOpenGL3_InvalidateState();
+
+    return true;
+  }
+
+  // Runs inside the renderer, which sets its own state up again after the callback
+  void Primitives::Render( const Batch &aBatch, const ImDrawCmd *aCommand ) {
+    ImDrawData *drawData = ImGui::GetDrawData();
+    ImVec2 position = drawData->DisplayPos;
+    ImVec2 size = drawData->DisplaySize;
+    ImVec2 scale = drawData->FramebufferScale;
+
+    const ImVec4 &clip = aCommand->ClipRect;
+    glScissor( ( int )( ( clip.x - position.x ) * scale.x ), ( int )( size.y * scale.y - ( clip.w - position.y ) * scale.y ),
+               ( int )( ( clip.z - clip.x ) * scale.x ), ( int )( ( clip.w - clip.y ) * scale.y ) );
+
+    float L = position.x;
+    float R = position.x + size.x;
+    float T = position.y;
+    float B = position.y + size.y;
+    const float projection[4][4] = {
+      { 2.0f / ( R - L ),   0.0f,         0.0f,   0.0f },
+      { 0.0f,         2.0f / ( T - B ),   0.0f,   0.0f },
+      { 0.0f,         0.0f,        -1.0f,   0.0f },
+      { ( R + L ) / ( L - R ), ( T + B ) / ( B - T ),  0.0f,   1.0f },
+    };
+
+    glUseProgram( mProgram );
+    glUniformMatrix4fv( mProjection, 1, GL_FALSE, &projection[0][0] );
+
+    Vertices.resize( ( aBatch.mEnd - aBatch.mBegin ) * 4 );
+    ShapeVertex *vertex = Vertices.data();
+
+    for( size_t i = aBatch.mBegin; i < aBatch.mEnd; ++i ) {
+      const Shape &shape = mShapes[i];
+      ImVec2 origin, extent, corners[4];
+      Prepare( shape, origin, extent );
+      Corners( shape, origin, extent, corners );
+
+      for( auto &corner : corners ) {
+        *vertex++ = { corner, ImVec2( corner.x - origin.x, corner.y - origin.y ), extent, ImVec2( shape.mThickness, ( float )shape.mKind ), shape.mColor };
+      }
+    }
+
+    // Reallocated only when it grows, like the backend's buffers
+    const size_t bytes = Vertices.size() * sizeof( ShapeVertex );
+    glBindBuffer( GL_ARRAY_BUFFER, mVertexBuffer );
+
+    if( bytes > mVertexBufferSize ) {
+      mVertexBufferSize = bytes + bytes / 2;
+      glBufferData( GL_ARRAY_BUFFER, ( GLsizeiptr )mVertexBufferSize, nullptr, GL_STREAM_DRAW );
+    }
+
+    glBufferSubData( GL_ARRAY_BUFFER, 0, ( GLsizeiptr )bytes, Vertices.data() );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer );
+
+    for( GLuint attrib = AttribPosition; attrib <= AttribColor; ++attrib ) {
+      glEnableVertexAttribArray( attrib );
+    }
+
+    size_t quads = aBatch.mEnd - aBatch.mBegin;
+
+    for( size_t first = 0; first < quads; first += MaxQuads ) {
+      const size_t base = first * 4 * sizeof( ShapeVertex );
+      glVertexAttribPointer( AttribPosition, 2, GL_FLOAT, GL_FALSE, sizeof( ShapeVertex ), ( GLvoid * )( base + IM_OFFSETOF( ShapeVertex, mPosition ) ) );
+      glVertexAttribPointer( AttribLocal, 2, GL_FLOAT, GL_FALSE, sizeof( ShapeVertex ), ( GLvoid * )( base + IM_OFFSETOF( ShapeVertex, mLocal ) ) );
+      glVertexAttribPointer( AttribExtent, 2, GL_FLOAT, GL_FALSE, sizeof( ShapeVertex ), ( GLvoid * )( base + IM_OFFSETOF( ShapeVertex, mExtent ) ) );
+      glVertexAttribPointer( AttribParams, 2, GL_FLOAT, GL_FALSE, sizeof( ShapeVertex ), ( GLvoid * )( base + IM_OFFSETOF( ShapeVertex, mParams ) ) );
+      glVertexAttribPointer( AttribColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof( ShapeVertex ), ( GLvoid * )( base + IM_OFFSETOF( ShapeVertex, mColor ) ) );
+      glDrawElements( GL_TRIANGLES, ( GLsizei )( ImMin( quads - first, MaxQuads ) * 6 ), GL_UNSIGNED_SHORT, nullptr );
+    }
+
+    for( GLuint attrib = AttribPosition; attrib <= AttribColor; ++attrib ) {
+      glDisableVertexAttribArray( attrib );
+    }
+  }
+
+  void Primitives::Tessellate( ImDrawList *aDrawList, size_t aBegin, size_t aEnd ) const {
+    for( size_t i = aBegin; i < aEnd; ++i ) {
+      const Shape &shape = mShapes[i];
+
+      switch( shape.mKind ) {
+        case Kind::Circle:
+          if( shape.mThickness > 0.0f ) {
+            aDrawList->AddCircle( shape.mA, shape.mB.x, shape.mColor, 0, shape.mThickness );
+          } else {
+            aDrawList->AddCircleFilled( shape.mA, shape.mB.x, shape.mColor, 0 );
+          }
+
+          break;
+
+        case Kind::Rect:
+          if( shape.mThickness > 0.0f ) {
+            aDrawList->AddRect( shape.mA, shape.mB, shape.mColor, 0.0f, 0, shape.mThickness );
+          } else {
+            aDrawList->AddRectFilled( shape.mA, shape.mB, shape.mColor );
+          }
+
+          break;
+
+        case Kind::Line:
+          aDrawList->AddLine( shape.mA, shape.mB, shape.mColor, shape.mThickness );
+          break;
+      }
+    }
+  }
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "../imgui/imgui.h"
+
+namespace Site {
+
+  // Circles, rectangles and lines drawn as one quad each, the fragment shader
+  // works out the coverage from the signed distance to the shape. Shapes are
+  // queued and handed to a draw list as a callback by Flush(), so they stay in
+  // order with everything else the draw list holds.
+  class Primitives {
+   public:
+    enum class Kind : uint8_t {
+      Circle,
+      Rect,
+      Line
+    };
+
+    // Coordinates are the ones given to the ImDrawList equivalents
+    struct Shape {
+      ImVec2 mA;          // center, min corner or first point
+      ImVec2 mB;          // radius in x, max corner or second point
+      float mThickness;   // 0 fills circles and rectangles
+      ImU32 mColor;
+      Kind mKind;
+    };
+
+    Primitives();
+
+    // Drops the shapes of the previous frame, which must have been rendered
+    void Clear();
+
+    void Circle( const ImVec2 &aCenter, float aRadius, ImU32 aColor, float aThickness = 0.0f );
+    void Rect( const ImVec2 &aMin, const ImVec2 &aMax, ImU32 aColor, float aThickness = 0.0f );
+    void Line( const ImVec2 &aFrom, const ImVec2 &aTo, ImU32 aColor, float aThickness = 1.0f );
+
+    // Hands the shapes queued since the last flush over to aDrawList
+    void Flush( ImDrawList *aDrawList );
+
+    // Folds the queued shapes into aSeed, the callbacks alone don't tell what they draw
+    uint32_t Hash( uint32_t aSeed ) const;
+
+    // Tessellates through ImDrawList instead, also used when the shader can't be built
+    inline void SetTessellated( bool aValue ) {
+      mTessellated = aValue;
+    }
+
+    inline bool IsTessellated() const {
+      return mTessellated || mDevice == Device::Failed;
+    }
+
+    // CPU reference of the fragment shader, coverage of the pixel centered on aPoint
+    static float Coverage( const Shape &aShape, const ImVec2 &aPoint );
+
+   private:
+    enum class Device : uint8_t {
+      None,
+      Ready,
+      Failed
+    };
+
+    struct Batch {
+      Primitives *mOwner;
+      size_t mBegin;
+      size_t mEnd;
+    };
+
+    static void RenderCallback( const ImDrawList *aDrawList, const ImDrawCmd *aCommand );
+
+    bool CreateDeviceObjects();
+    void Render( const Batch &aBatch, const ImDrawCmd *aCommand );
+    void Tessellate( ImDrawList *aDrawList, size_t aBegin, size_t aEnd ) const;
+
+    std::vector<Shape> mShapes;
+    std::deque<Batch> mBatches; // callbacks point at them, a deque doesn't move them
+    size_t mFlushed;
+    bool mTessellated;
+    Device mDevice;
+
+    unsigned int mProgram;
+    unsigned int mVertexBuffer;
+    unsigned int mIndexBuffer;
+    size_t mVertexBufferSize; // bytes allocated, only grows
+    int mProjection;
+  };
+
+}
@@ -4,16 +4,55 @@
 #include "../sol/sol.h"
 #include "../editor/TextEditor.h"
 #include "background.h"
+#include "diagnostics.h"
+#include "memory.h"
 
 namespace Site {
 
   static sol::state Lua;
   static TextEditor Editor;
   static std::string output;
+  static Diagnostics Checker;
+  static sol::protected_function Runnable;
+  static TextEditor::ErrorMarkers SyntaxErrors;
+  static TextEditor::ErrorMarkers Errors;
+  static bool Animated;
+  static ImVector<ImDrawList *> DrawLists;
+
+  void Compile( const std::string &aText ) {
+    sol::load_result chunk = Lua.load( aText );
+
+    if( chunk.valid() ) {
+      Runnable = chunk.get<sol::protected_function>();
+      Offscreen.InvalidateAll();
+      Images.Clear();
+    }
+  }
+
+  // Calls the function in its upvalue, noting that the script animates
+  int Animate( lua_State *L ) {
+    Animated = true;
+    lua_pushvalue( L, lua_upvalueindex( 1 ) );
+    lua_insert( L, 1 );
+    lua_call( L, lua_gettop( L ) - 1, LUA_MULTRET );
+    return lua_gettop( L );
+  }
+
+  // A script reading the clock or random numbers likely draws something else every frame
+  void WatchAnimated( const char *aLibrary, const char *aName ) {
+    lua_State *L = Lua.lua_state();
+    lua_getglobal( L, aLibrary );
+    lua_getfield( L, -1, aName );
+    lua_pushcclosure( L, Animate, 1 );
+    lua_setfield( L, -2, aName );
+    lua_pop( L, 1 );
+  }
 
   void Init() {
     Lua.open_libraries();
     Editor.SetPalette( TextEditor::GetLightPalette() );
+    Editor.SetShowMinimap( true );
+    Editor.SetRetained( true );
 
     Editor.SetText( std::string(
                       "start = os.clock()\n"
@@ -52,9 +91,26 @@ namespace Site {
     sol::table util = Lua["util"].get_or_create<sol::table>();
 
 		util.set_function( "delta", []() {
+      Animated = true;
       return ImGui::GetIO().DeltaTime;
     } );
 
+    // for scripts that change over time without asking for it
+    util.set_function( "animate", []() {
+      Animated = true;
+    } );
+
+    // allocations of the last frame, to see them settle
+    util.set_function( "memory", []() {
+      const MemoryStats &stats = GetMemoryStats();
+      return std::make_tuple( stats.mAllocations, stats.mFrees, stats.mSystemAllocations, stats.mFrameBytes );
+    } );
+
+    WatchAnimated( "os", "clock" );
+    WatchAnimated( "os", "time" );
+    WatchAnimated( "math", "random" );
+
+    Compile( Editor.GetText() );
   }
 
   class splitter : public std::string {};
@@ -74,16 +130,41 @@ namespace Site {
 
     for( auto token : tokens ) {
       if( std::all_of( token.begin(), token.end(), isdigit ) ) {
-        Editor.SetErrorMarkers( { { std::stoi( token ), error} } );
+        Errors[std::stoi( token )] = error;
       }
     }
   }
 
+  // Syntax errors come from the background checker, the script is only
+  // recompiled once a checked snapshot of the text parsed cleanly
+  void Diagnose() {
+    if( Editor.IsTextChanged() ) {
+      Checker.Submit( Editor.GetText(), ImGui::GetTime() );
+    }
+
+    std::string text;
+    std::vector<Diagnostic> diagnostics;
+
+    if( Checker.Poll( ImGui::GetTime(), text, diagnostics ) ) {
+      SyntaxErrors.clear();
+
+      for( auto &diagnostic : diagnostics ) {
+        SyntaxErrors[diagnostic.mLine] = "column " + std::to_string( diagnostic.mColumn ) + ": " + diagnostic.mMessage;
+      }
+
+      if( diagnostics.empty() ) {
+        Compile( text );
+      }
+    }
+
+    Errors = SyntaxErrors;
+  }
+
   void Script() {
-    sol::load_result runnable = Lua.load( Editor.GetText() );
+    Animated = false;
 
-    if( !runnable.valid() ) {
-      lua_error( sol::error( runnable ).what() );
+    if( !Runnable.valid() ) {
+      return;
     }
 
     auto timeout = []( lua_State * L, lua_Debug * ) {
@@ -92,7 +173,7 @@ namespace Site {
 
     lua_sethook( Lua.lua_state(), timeout, LUA_MASKCOUNT, 40960 );
 
-    sol::safe_function_result result = runnable();
+    sol::safe_function_result result = Runnable();
 
     lua_sethook( Lua.lua_state(), timeout, 0, 0 );
 
@@ -112,19 +193,56 @@ namespace Site {
   void Tick() {
     Background background;
 
+    Diagnose();
     Script();
 
     ImGui::SetNextWindowPos( ImVec2( 20, 20 ), ImGuiCond_Once );
     ImGui::SetNextWindowSize( ImVec2( 600, 600 ), ImGuiCond_Once );
 
     if( ImGui::Begin( "Editor" ) ) {
+      Editor.SetErrorMarkers( Errors );
       Editor.Render( "#Editor", ImVec2( -1, ImGui::GetTextLineHeight() * 32 ) );
-      ImGui::InputTextMultiline( "#output", output.data(), output.length(), ImVec2( -1, -1 ), ImGuiInputTextFlags_ReadOnly );
-      Editor.SetErrorMarkers( { } );
+      // The size counts the zero-terminator, which std::string keeps after its data
+      ImGui::InputTextMultiline( "#output", output.data(), output.length() + 1, ImVec2( -1, -1 ), ImGuiInputTextFlags_ReadOnly );
     }
     ImGui::End();
 
     output.clear();
   }
 
+  void Compose( ImDrawData *aDrawData ) {
+    Draw._PopUnusedDrawCmd();
+
+    if( Draw.CmdBuffer.Size == 0 ) {
+      return;
+    }
+
+    // Same limit as the window draw lists ImGui adds itself
+    IM_ASSERT( sizeof( ImDrawIdx ) != 2 || Draw.VtxBuffer.Size < ( 1 << 16 ) || ( ImGui::GetIO().BackendFlags & ImGuiBackendFlags_RendererHasVtxOffset ) );
+
+    DrawLists.resize( 0 );
+    DrawLists.push_back( &Draw );
+
+    for( int n = 0; n < aDrawData->CmdListsCount; n++ ) {
+      DrawLists.push_back( aDrawData->CmdLists[n] );
+    }
+
+    aDrawData->CmdLists = DrawLists.Data;
+    aDrawData->CmdListsCount = DrawLists.Size;
+    aDrawData->TotalVtxCount += Draw.VtxBuffer.Size;
+    aDrawData->TotalIdxCount += Draw.IdxBuffer.Size;
+  }
+
+  bool IsAnimating() {
+    return Animated || Checker.IsPending();
+  }
+
+  unsigned int DrawHash( unsigned int aSeed ) {
+    return Images.Hash( Offscreen.Hash( Shapes.Hash( aSeed ) ) );
+  }
+
+  void RenderLayers() {
+    Offscreen.Render();
+  }
+
 }
@@ -1,9 +1,24 @@
 
+struct ImDrawData;
+
 namespace Site {
 
   void Init();
   void Tick();
 
+  // Puts what the scripts drew behind every window, call after ImGui::Render()
+  void Compose( ImDrawData *aDrawData );
+
+  // True while the last script run read the clock or random numbers, or asked
+  // for frames with util.animate(), and while a syntax check is on its way
+  bool IsAnimating();
+
+  // Folds what the site drew through draw callbacks into aSeed
+  unsigned int DrawHash( unsigned int aSeed );
+
+  // Renders the layers drawn this frame into their textures, call before drawing the frame
+  void RenderLayers();
+
 }
 
 /*
@@ -0,0 +1,203 @@
+#include "sprites.h"
+
+#include "../imgui/imgui_internal.h"
+
+#include <GLES2/gl2.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+#endif
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"          // warning: 'xxxx' defined but not used
+#endif
+
+#define STBRP_STATIC
+#define STBRP_ASSERT(x) IM_ASSERT(x)
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "../imgui/imstb_rectpack.h"
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+
+namespace Site {
+
+  // Size of a shared atlas, larger images get a texture of their own
+  static const int PageSize = 1024;
+
+  // Left between images, so scaled sprites don't pick up their neighbours' edges
+  static const int Padding = 1;
+
+  // An atlas texture, packed as images come in
+  struct Sprites::Page {
+    stbrp_context mContext;
+    std::vector<stbrp_node> mNodes;
+    int mWidth, mHeight;
+    GLuint mTexture;
+  };
+
+  Sprites::Sprites()
+    : mMaxSize( 0 )
+    , mVersion( 0 ) {
+  }
+
+  // Defined here, where Page is complete
+  Sprites::~Sprites() = default;
+
+  int Sprites::Load( std::string_view aName, int aWidth, int aHeight, const ImU32 *aPixels ) {
+    if( aWidth <= 0 || aHeight <= 0 ) {
+      return -1;
+    }
+
+    ImGuiID hash = ImHashData( aPixels, aWidth * aHeight * sizeof( ImU32 ) );
+    auto name = mNames.find( aName );
+    int id;
+
+    if( name == mNames.end() ) {
+      Sprite sprite = {};
+
+      if( !Place( sprite, aWidth, aHeight ) ) {
+        return -1;
+      }
+
+      id = ( int )mSprites.size();
+      mSprites.push_back( sprite );
+      mNames.emplace( aName, id );
+    } else {
+      id = name->second;
+      Sprite &sprite = mSprites[id];
+
+      if( sprite.mHash == hash && sprite.mWidth == aWidth && sprite.mHeight == aHeight ) {
+        return id;
+      }
+
+      // The old space stays unused until Clear(), images rarely change size
+      if( ( sprite.mWidth != aWidth || sprite.mHeight != aHeight ) && !Place( sprite, aWidth, aHeight ) ) {
+        return -1;
+      }
+    }
+
+    Sprite &sprite = mSprites[id];
+    sprite.mHash = hash;
+
+    GLint lastTexture;
+    glGetIntegerv( GL_TEXTURE_BINDING_2D, &lastTexture );
+    glBindTexture( GL_TEXTURE_2D, mPages[sprite.mPage]->mTexture );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+    glTexSubImage2D( GL_TEXTURE_2D, 0, sprite.mX, sprite.mY, aWidth, aHeight, GL_RGBA, GL_UNSIGNED_BYTE, aPixels );
+    glBindTexture( GL_TEXTURE_2D, ( GLuint )lastTexture );
+    ++mVersion;
+
+    return id;
+  }
+
+  void Sprites::Clear() {
+    for( auto &page : mPages ) {
+      glDeleteTextures( 1, &page->mTexture );
+    }
+
+    mPages.clear();
+    mSprites.clear();
+    mNames.clear();
+    ++mVersion;
+  }
+
+  bool Sprites::Draw( ImDrawList *aDrawList, int aId, const ImVec2 &aMin, const ImVec2 &aMax, ImU32 aTint ) const {
+    if( aId < 0 || aId >= ( int )mSprites.size() ) {
+      return false;
+    }
+
+    // AddImage() merges the command with the previous one when it's on the same page
+    const Sprite &sprite = mSprites[aId];
+    aDrawList->AddImage( ( ImTextureID )( intptr_t )mPages[sprite.mPage]->mTexture, aMin, aMax, sprite.mUv0, sprite.mUv1, aTint );
+    return true;
+  }
+
+  ImVec2 Sprites::GetSize( int aId ) const {
+    if( aId < 0 || aId >= ( int )mSprites.size() ) {
+      return ImVec2( 0.0f, 0.0f );
+    }
+
+    return ImVec2( ( float )mSprites[aId].mWidth, ( float )mSprites[aId].mHeight );
+  }
+
+  uint32_t Sprites::Hash( uint32_t aSeed ) const {
+    return ImHashData( &mVersion, sizeof( mVersion ), aSeed );
+  }
+
+  // Finds room for aWidth x aHeight pixels on the first page that has it
+  bool Sprites::Place( Sprite &aSprite, int aWidth, int aHeight ) {
+    if( mMaxSize == 0 ) {
+      glGetIntegerv( GL_MAX_TEXTURE_SIZE, &mMaxSize );
+    }
+
+    // Checked before narrowing to stbrp_coord, which would wrap large sizes
+    if( aWidth + Padding > mMaxSize || aHeight + Padding > mMaxSize ) {
+      return false;
+    }
+
+    stbrp_rect rect = {};
+    rect.w = ( stbrp_coord )( aWidth + Padding );
+    rect.h = ( stbrp_coord )( aHeight + Padding );
+
+    int page = 0;
+
+    for( ; page < ( int )mPages.size(); ++page ) {
+      stbrp_pack_rects( &mPages[page]->mContext, &rect, 1 );
+
+      if( rect.was_packed ) {
+        break;
+      }
+    }
+
+    if( page == ( int )mPages.size() ) {
+      int size = ImMin( PageSize, mMaxSize );
+      page = AddPage( ImMax( size, ( int )rect.w ), ImMax( size, ( int )rect.h ) );
+      stbrp_pack_rects( &mPages[page]->mContext, &rect, 1 );
+      IM_ASSERT( rect.was_packed );
+    }
+
+    const Page &target = *mPages[page];
+    aSprite.mPage = page;
+    aSprite.mX = rect.x;
+    aSprite.mY = rect.y;
+    aSprite.mWidth = aWidth;
+    aSprite.mHeight = aHeight;
+    aSprite.mUv0 = ImVec2( ( float )rect.x / target.mWidth, ( float )rect.y / target.mHeight );
+    aSprite.mUv1 = ImVec2( ( float )( rect.x + aWidth ) / target.mWidth, ( float )( rect.y + aHeight ) / target.mHeight );
+
+    return true;
+  }
+
+  int Sprites::AddPage( int aWidth, int aHeight ) {
+    auto page = std::make_unique<Page>();
+    page->mWidth = aWidth;
+    page->mHeight = aHeight;
+    page->mNodes.resize( aWidth );
+    stbrp_init_target( &page->mContext, aWidth, aHeight, page->mNodes.data(), aWidth );
+
+    GLint lastTexture;
+    glGetIntegerv( GL_TEXTURE_BINDING_2D, &lastTexture );
+    glGenTextures( 1, &page->mTexture );
+    glBindTexture( GL_TEXTURE_2D, page->mTexture );
+
+    // Pixel art scaled up stays sharp
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+    glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, aWidth, aHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr );
+    glBindTexture( GL_TEXTURE_2D, ( GLuint )lastTexture );
+
+    mPages.push_back( std::move( page ) );
+    return ( int )mPages.size() - 1;
+  }
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../imgui/imgui.h"
+
+namespace Site {
+
+  // Images of the scripts packed into shared atlas textures, so sprites drawn
+  // one after the other end up in the same draw command. Pixels go to the GPU
+  // when an image is loaded, and atlases are never repacked, so the UVs of
+  // sprites already drawn stay valid.
+  class Sprites {
+   public:
+    Sprites();
+    ~Sprites();
+
+    // Loads aWidth x aHeight pixels, packed as IM_COL32, under aName and
+    // returns its id. Loading a name again keeps the id and only uploads
+    // pixels that changed. Returns -1 when the image can't be a texture.
+    int Load( std::string_view aName, int aWidth, int aHeight, const ImU32 *aPixels );
+
+    // Drops every image, their ids aren't valid anymore
+    void Clear();
+
+    // Draws image aId stretched over aMin to aMax, returns false when there's no such image
+    bool Draw( ImDrawList *aDrawList, int aId, const ImVec2 &aMin, const ImVec2 &aMax, ImU32 aTint ) const;
+
+    // Size of image aId in pixels, or 0 when there's no such image
+    ImVec2 GetSize( int aId ) const;
+
+    // Folds the uploads into aSeed, draw data doesn't change with the pixels
+    uint32_t Hash( uint32_t aSeed ) const;
+
+   private:
+    struct Page;
+
+    struct Sprite {
+      int mPage;
+      int mX, mY;
+      int mWidth, mHeight;
+      ImVec2 mUv0, mUv1;
+      ImGuiID mHash;
+    };
+
+    bool Place( Sprite &aSprite, int aWidth, int aHeight );
+    int AddPage( int aWidth, int aHeight );
+
+    std::map<std::string, int, std::less<>> mNames;
+    std::vector<Sprite> mSprites;
+    std::vector<std::unique_ptr<Page>> mPages;
+    int mMaxSize;       // of a texture, 0 until asked
+    uint32_t mVersion;  // counts uploads
+  };
+
+}
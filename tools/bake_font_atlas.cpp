@@ -0,0 +1,50 @@
+// Bakes the default font atlas into a blob for ImFontAtlasBuildLoadBaked(), so the
+// page doesn't rasterize the font at startup. Built and run on the host by
+// `xmake bake-font`, which regenerates src/site/font_atlas.cpp.
+#include <cstdio>
+
+#include "../src/imgui/imgui.h"
+#include "../src/imgui/imgui_internal.h"
+
+int main( int argc, char **argv ) {
+  if( argc != 2 ) {
+    fprintf( stderr, "usage: %s <output.cpp>\n", argv[0] );
+    return 1;
+  }
+
+  // Same atlas as the page builds on its own, only the default font
+  ImFontAtlas atlas;
+  unsigned char *pixels;
+  int width, height;
+  atlas.GetTexDataAsAlpha8( &pixels, &width, &height );
+
+  ImVector<unsigned char> blob;
+
+  if( !ImFontAtlasBuildSaveBaked( &atlas, &blob ) ) {
+    fprintf( stderr, "Failed to bake the font atlas\n" );
+    return 1;
+  }
+
+  FILE *out = fopen( argv[1], "wb" );
+
+  if( !out ) {
+    fprintf( stderr, "Failed to open %s\n", argv[1] );
+    return 1;
+  }
+
+  fprintf( out, "// Generated by tools/bake_font_atlas.cpp through `xmake bake-font`, do not edit\n" );
+  fprintf( out, "// %dx%d atlas, %d bytes\n", width, height, blob.Size );
+  fprintf( out, "#include \"font_atlas.h\"\n\n" );
+  fprintf( out, "namespace Site {\n\n" );
+  fprintf( out, "  const unsigned char FontAtlasBlob[] = {" );
+
+  for( int i = 0; i < blob.Size; i++ ) {
+    fprintf( out, "%s0x%02x,", i % 16 == 0 ? "\n    " : " ", blob[i] );
+  }
+
+  fprintf( out, "\n  };\n\n" );
+  fprintf( out, "  const unsigned int FontAtlasBlobSize = sizeof( FontAtlasBlob );\n\n" );
+  fprintf( out, "}\n" );
+  fclose( out );
+  return 0;
+}
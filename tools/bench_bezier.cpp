@@ -0,0 +1,150 @@
+// Compares auto-tessellated PathBezierCurveTo(), which forward-differences a
+// segment count from Wang's formula, with the recursive de Casteljau
+// subdivision it replaced. Prints the time per curve, the points per curve and
+// the largest distance between the curve and its segments.
+// Built and run on the host by `xmake bench-bezier`.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#define IMGUI_DEFINE_MATH_OPERATORS
+#include "../src/imgui/imgui.h"
+#include "../src/imgui/imgui_internal.h"
+
+static double Now() {
+  return std::chrono::duration<double>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+// The subdivision PathBezierCurveTo() used before, kept as the reference
+static void PathBezierToCasteljau( ImVector<ImVec2> *path, float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4, float tess_tol, int level ) {
+  float dx = x4 - x1;
+  float dy = y4 - y1;
+  float d2 = ( ( x2 - x4 ) * dy - ( y2 - y4 ) * dx );
+  float d3 = ( ( x3 - x4 ) * dy - ( y3 - y4 ) * dx );
+  d2 = ( d2 >= 0 ) ? d2 : -d2;
+  d3 = ( d3 >= 0 ) ? d3 : -d3;
+
+  if( ( d2 + d3 ) * ( d2 + d3 ) < tess_tol * ( dx * dx + dy * dy ) ) {
+    path->push_back( ImVec2( x4, y4 ) );
+  } else if( level < 10 ) {
+    float x12 = ( x1 + x2 ) * 0.5f,       y12 = ( y1 + y2 ) * 0.5f;
+    float x23 = ( x2 + x3 ) * 0.5f,       y23 = ( y2 + y3 ) * 0.5f;
+    float x34 = ( x3 + x4 ) * 0.5f,       y34 = ( y3 + y4 ) * 0.5f;
+    float x123 = ( x12 + x23 ) * 0.5f,    y123 = ( y12 + y23 ) * 0.5f;
+    float x234 = ( x23 + x34 ) * 0.5f,    y234 = ( y23 + y34 ) * 0.5f;
+    float x1234 = ( x123 + x234 ) * 0.5f, y1234 = ( y123 + y234 ) * 0.5f;
+    PathBezierToCasteljau( path, x1, y1,        x12, y12,    x123, y123,  x1234, y1234, tess_tol, level + 1 );
+    PathBezierToCasteljau( path, x1234, y1234,  x234, y234,  x34, y34,    x4, y4,       tess_tol, level + 1 );
+  }
+}
+
+struct Curve {
+  ImVec2 p1, p2, p3, p4;
+};
+
+// Largest distance from points sampled along the curve to the polyline
+static float MaxError( const Curve &curve, const ImVector<ImVec2> &path ) {
+  float max_dist = 0.0f;
+
+  for( int i = 0; i <= 64; i++ ) {
+    ImVec2 p = ImBezierCalc( curve.p1, curve.p2, curve.p3, curve.p4, i / 64.0f );
+    float best = FLT_MAX;
+
+    for( int n = 1; n < path.Size; n++ ) {
+      best = ImMin( best, ImLengthSqr( p - ImLineClosestPoint( path[n - 1], path[n], p ) ) );
+    }
+
+    max_dist = ImMax( max_dist, ImSqrt( best ) );
+  }
+
+  return max_dist;
+}
+
+static void Run( const char *name, const ImVector<Curve> &curves, float tess_tol ) {
+  ImDrawList draw_list( ImGui::GetDrawListSharedData() );
+  ImVector<ImVec2> path;
+  double best_auto = 1e9, best_recursive = 1e9;
+  size_t points_auto = 0, points_recursive = 0;
+
+  for( int run = 0; run < 5; run++ ) {
+    points_auto = points_recursive = 0;
+    double start = Now();
+
+    for( const Curve &curve : curves ) {
+      draw_list.PathClear();
+      draw_list.PathLineTo( curve.p1 );
+      draw_list.PathBezierCurveTo( curve.p2, curve.p3, curve.p4, 0 );
+      points_auto += draw_list._Path.Size;
+    }
+
+    best_auto = ImMin( best_auto, Now() - start );
+    start = Now();
+
+    for( const Curve &curve : curves ) {
+      path.resize( 0 );
+      path.push_back( curve.p1 );
+      PathBezierToCasteljau( &path, curve.p1.x, curve.p1.y, curve.p2.x, curve.p2.y, curve.p3.x, curve.p3.y, curve.p4.x, curve.p4.y, tess_tol, 0 );
+      points_recursive += path.Size;
+    }
+
+    best_recursive = ImMin( best_recursive, Now() - start );
+  }
+
+  // The error on a subset, measuring it is much slower than tessellating
+  float error_auto = 0.0f, error_recursive = 0.0f;
+
+  for( int i = 0; i < curves.Size; i += curves.Size / 500 ) {
+    const Curve &curve = curves[i];
+    draw_list.PathClear();
+    draw_list.PathLineTo( curve.p1 );
+    draw_list.PathBezierCurveTo( curve.p2, curve.p3, curve.p4, 0 );
+    error_auto = ImMax( error_auto, MaxError( curve, draw_list._Path ) );
+
+    path.resize( 0 );
+    path.push_back( curve.p1 );
+    PathBezierToCasteljau( &path, curve.p1.x, curve.p1.y, curve.p2.x, curve.p2.y, curve.p3.x, curve.p3.y, curve.p4.x, curve.p4.y, tess_tol, 0 );
+    error_recursive = ImMax( error_recursive, MaxError( curve, path ) );
+  }
+
+  printf( "%s, %d curves\n", name, curves.Size );
+  printf( "  forward differences: %7.1f ns/curve, %6.1f points/curve, max error %.3f px\n", best_auto * 1e9 / curves.Size, ( double )points_auto / curves.Size, error_auto );
+  printf( "  recursive:           %7.1f ns/curve, %6.1f points/curve, max error %.3f px\n", best_recursive * 1e9 / curves.Size, ( double )points_recursive / curves.Size, error_recursive );
+}
+
+static ImVector<Curve> RandomCurves( int count, float size ) {
+  ImVector<Curve> curves;
+  curves.resize( count );
+
+  for( Curve &curve : curves ) {
+    ImVec2 *points = &curve.p1;
+
+    for( int i = 0; i < 4; i++ ) {
+      points[i] = ImVec2( ( float )rand() / RAND_MAX * size, ( float )rand() / RAND_MAX * size );
+    }
+  }
+
+  return curves;
+}
+
+int main() {
+  ImGui::CreateContext();
+  ImGuiIO &io = ImGui::GetIO();
+  io.DisplaySize = ImVec2( 1920, 1080 );
+  io.IniFilename = NULL;
+  unsigned char *pixels;
+  int width, height;
+  io.Fonts->GetTexDataAsRGBA32( &pixels, &width, &height );
+  ImGui::NewFrame();
+
+  const float tess_tol = ImGui::GetDrawListSharedData()->CurveTessellationTol;
+  printf( "CurveTessellationTol %.2f\n", tess_tol );
+
+  srand( 1 );
+  Run( "Small curves in 32 px", RandomCurves( 100000, 32.0f ), tess_tol );
+  Run( "Curves in 512 px", RandomCurves( 100000, 512.0f ), tess_tol );
+  Run( "Large curves in 4096 px", RandomCurves( 20000, 4096.0f ), tess_tol );
+
+  ImGui::EndFrame();
+  ImGui::DestroyContext();
+  return 0;
+}
@@ -0,0 +1,157 @@
+// Times ImHashStr() on the kind of IDs widgets hash ("##Background",
+// "#Editor", "label###id", paths) and ImHashData() on blocks of a few sizes,
+// against a copy of the byte at a time CRC32 loop the slice-by-8 tables
+// replaced. Hashes are compared too, IDs must not change.
+// Built and run on the host by `xmake bench-hash`.
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "../src/imgui/imgui.h"
+#include "../src/imgui/imgui_internal.h"
+
+static double Now() {
+  return std::chrono::duration<double>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+// The same table as GCrc32LookupTable, generated from the polynomial
+static ImU32 Crc32Lut[256];
+
+static void BuildCrc32Lut() {
+  for( ImU32 n = 0; n < 256; n++ ) {
+    ImU32 crc = n;
+
+    for( int k = 0; k < 8; k++ ) {
+      crc = ( crc & 1 ) ? ( crc >> 1 ) ^ 0xEDB88320 : crc >> 1;
+    }
+
+    Crc32Lut[n] = crc;
+  }
+}
+
+// The ImHashData() and ImHashStr() loops from before the slice-by-8 tables, kept as the reference
+static ImU32 HashDataBytes( const void *data_p, size_t data_size, ImU32 seed ) {
+  ImU32 crc = ~seed;
+  const unsigned char *data = ( const unsigned char * )data_p;
+
+  while( data_size-- != 0 ) {
+    crc = ( crc >> 8 ) ^ Crc32Lut[( crc & 0xFF ) ^ *data++];
+  }
+
+  return ~crc;
+}
+
+static ImU32 HashStrBytes( const char *data_p, size_t data_size, ImU32 seed ) {
+  seed = ~seed;
+  ImU32 crc = seed;
+  const unsigned char *data = ( const unsigned char * )data_p;
+
+  if( data_size != 0 ) {
+    while( data_size-- != 0 ) {
+      unsigned char c = *data++;
+
+      if( c == '#' && data_size >= 2 && data[0] == '#' && data[1] == '#' ) {
+        crc = seed;
+      }
+
+      crc = ( crc >> 8 ) ^ Crc32Lut[( crc & 0xFF ) ^ c];
+    }
+  } else {
+    while( unsigned char c = *data++ ) {
+      if( c == '#' && data[0] == '#' && data[1] == '#' ) {
+        crc = seed;
+      }
+
+      crc = ( crc >> 8 ) ^ Crc32Lut[( crc & 0xFF ) ^ c];
+    }
+  }
+
+  return ~crc;
+}
+
+int main() {
+  BuildCrc32Lut();
+
+  const char *ids[] = {
+    "##Background", "#Editor", "Output", "Run###run", "Save##toolbar", "##scrollbar",
+    "Console output###console", "examples/shapes/bezier.lua", "##InputText", "Debug##Default",
+  };
+  const int id_count = IM_ARRAYSIZE( ids );
+  const int repeats = 2000000;
+  ImU32 seed = 0x12345678;
+  int mismatches = 0;
+
+  for( int i = 0; i < id_count; i++ ) {
+    if( ImHashStr( ids[i], 0, seed ) != HashStrBytes( ids[i], 0, seed ) || ImHashStr( ids[i], strlen( ids[i] ), seed ) != HashStrBytes( ids[i], strlen( ids[i] ), seed ) ) {
+      mismatches++;
+    }
+  }
+
+  double best_new = 1e9, best_old = 1e9;
+  ImU32 sink = 0;
+
+  for( int run = 0; run < 5; run++ ) {
+    double start = Now();
+
+    for( int r = 0; r < repeats; r++ ) {
+      sink += ImHashStr( ids[r % id_count], 0, seed + r );
+    }
+
+    best_new = ImMin( best_new, Now() - start );
+    start = Now();
+
+    for( int r = 0; r < repeats; r++ ) {
+      sink += HashStrBytes( ids[r % id_count], 0, seed + r );
+    }
+
+    best_old = ImMin( best_old, Now() - start );
+  }
+
+  printf( "ImHashStr, %d widget IDs\n", id_count );
+  printf( "  slice-by-8:     %6.2f ns/ID\n", best_new * 1e9 / repeats );
+  printf( "  byte at a time: %6.2f ns/ID\n", best_old * 1e9 / repeats );
+
+  const int block_sizes[] = { 4, 16, 64, 256, 4096 };
+  ImVector<unsigned char> block;
+  block.resize( 4096 );
+
+  for( int i = 0; i < block.Size; i++ ) {
+    block[i] = ( unsigned char )( i * 131 + 7 );
+  }
+
+  printf( "ImHashData\n" );
+
+  for( int block_size : block_sizes ) {
+    // About 256MB hashed per case
+    const int block_repeats = ( 256 << 20 ) / block_size;
+
+    if( ImHashData( block.Data, block_size, seed ) != HashDataBytes( block.Data, block_size, seed ) ) {
+      mismatches++;
+    }
+
+    best_new = best_old = 1e9;
+
+    for( int run = 0; run < 5; run++ ) {
+      double start = Now();
+
+      for( int r = 0; r < block_repeats; r++ ) {
+        sink += ImHashData( block.Data, block_size, seed + r );
+      }
+
+      best_new = ImMin( best_new, Now() - start );
+      start = Now();
+
+      for( int r = 0; r < block_repeats; r++ ) {
+        sink += HashDataBytes( block.Data, block_size, seed + r );
+      }
+
+      best_old = ImMin( best_old, Now() - start );
+    }
+
+    printf( "  %4d bytes: slice-by-8 %5.2f GB/s, byte at a time %5.2f GB/s\n", block_size,
+            ( double )block_repeats * block_size / best_new / 1e9, ( double )block_repeats * block_size / best_old / 1e9 );
+  }
+
+  printf( "%d mismatched hashes (%08x)\n", mismatches, sink );
+  return mismatches != 0;
+}
@@ -0,0 +1,83 @@
+// Times ImDrawList::AddPolyline() on thin and thick, anti-aliased and aliased
+// polylines. Built and run on the host by `xmake bench-polyline`, once with the
+// SIMD normal and edge passes and once with IMGUI_DISABLE_SIMD. The vertex hash
+// tells whether both builds tessellate the same.
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#include "../src/imgui/imgui.h"
+#include "../src/imgui/imgui_internal.h"
+
+static double Now() {
+  return std::chrono::duration<double>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+int main() {
+  ImGui::CreateContext();
+  ImGuiIO &io = ImGui::GetIO();
+  io.DisplaySize = ImVec2( 1920, 1080 );
+  io.IniFilename = NULL;
+  unsigned char *pixels;
+  int width, height;
+  io.Fonts->GetTexDataAsRGBA32( &pixels, &width, &height );
+  ImGui::NewFrame();
+
+#if defined(IMGUI_DISABLE_SIMD)
+  printf( "AddPolyline, scalar\n" );
+#else
+  printf( "AddPolyline, SIMD when available\n" );
+#endif
+
+  // A wavy line across the screen, so every join has a different normal
+  const int point_counts[] = { 16, 256, 4096, 65536 };
+  const float thicknesses[] = { 1.0f, 4.0f };
+  ImVector<ImVec2> points;
+  ImDrawList draw_list( ImGui::GetDrawListSharedData() );
+
+  for( int point_count : point_counts ) {
+    points.resize( point_count );
+
+    for( int i = 0; i < point_count; i++ ) {
+      float t = ( float )i / point_count;
+      points[i] = ImVec2( 10.0f + t * 1900.0f, 540.0f + 400.0f * sinf( t * 60.0f ) * cosf( t * 7.0f ) );
+    }
+
+    for( int anti_aliased = 1; anti_aliased >= 0; anti_aliased-- ) {
+      for( float thickness : thicknesses ) {
+        // About 4M points per case
+        const int repeats = ImMax( 1, ( 4 << 20 ) / point_count );
+        ImU32 hash = 0;
+        double best = 1e9;
+
+        for( int run = 0; run < 5; run++ ) {
+          draw_list._ResetForNewFrame();
+          draw_list.PushClipRectFullScreen();
+          draw_list.Flags = anti_aliased ? ImDrawListFlags_AntiAliasedLines : ImDrawListFlags_None;
+          double start = Now();
+
+          for( int r = 0; r < repeats; r++ ) {
+            // Reuses the buffers, so the time is tessellation and not allocation
+            draw_list.VtxBuffer.resize( 0 );
+            draw_list.IdxBuffer.resize( 0 );
+            draw_list.CmdBuffer.back().ElemCount = 0;
+            draw_list._VtxCurrentIdx = 0;
+            draw_list._VtxWritePtr = draw_list.VtxBuffer.Data;
+            draw_list._IdxWritePtr = draw_list.IdxBuffer.Data;
+            draw_list.AddPolyline( points.Data, point_count, IM_COL32( 255, 200, 50, 255 ), ( r & 1 ) != 0, thickness );
+          }
+
+          best = ImMin( best, Now() - start );
+          hash = ImHashData( draw_list.VtxBuffer.Data, ( size_t )draw_list.VtxBuffer.size_in_bytes() );
+        }
+
+        printf( "  %6d points, %s, thickness %.0f: %7.2f ns/point, %6d vertices, hash %08x\n", point_count, anti_aliased ? "AA   " : "no AA", thickness,
+                best * 1e9 / ( ( double )repeats * point_count ), draw_list.VtxBuffer.Size, hash );
+      }
+    }
+  }
+
+  ImGui::EndFrame();
+  ImGui::DestroyContext();
+  return 0;
+}
@@ -0,0 +1,95 @@
+// Times ImGuiStorage with 10k, 100k and 1M IDs: building it in bulk, adding
+// IDs one at a time and finding IDs that are and aren't there. Built and run on
+// the host by `xmake bench-storage`, once with the sorted pairs and once with
+// IMGUI_USE_HASHED_STORAGE. Adding IDs one at a time to the sorted pairs moves
+// half of them each time, so only 2000 are added to a storage already holding
+// the others, which gives the cost per ID at that size.
+#include <chrono>
+#include <cstdio>
+
+#include "../src/imgui/imgui.h"
+#include "../src/imgui/imgui_internal.h"
+
+static double Now() {
+  return std::chrono::duration<double>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+// CRC32 of a 32 bit counter, unique and spread like the IDs widgets hash
+static ImGuiID MakeID( int n ) {
+  return ImHashData( &n, sizeof( n ), 0 );
+}
+
+static void Fill( ImGuiStorage &storage, int count ) {
+  storage.Clear();
+  storage.Data.reserve( count );
+
+  for( int n = 0; n < count; n++ ) {
+    storage.Data.push_back( ImGuiStorage::ImGuiStoragePair( MakeID( n ), n ) );
+  }
+
+  storage.BuildSortByKey();
+}
+
+static void Run( int count ) {
+  const int added = 2000;
+  const int lookups = 1000000;
+  ImGuiStorage storage;
+  double best_build = 1e9, best_add = 1e9, best_hit = 1e9, best_miss = 1e9;
+  int errors = 0;
+  ImS64 sink = 0;
+
+  for( int run = 0; run < 5; run++ ) {
+    double start = Now();
+    Fill( storage, count );
+    best_build = ImMin( best_build, Now() - start );
+
+    start = Now();
+
+    for( int n = count; n < count + added; n++ ) {
+      storage.SetInt( MakeID( n ), n );
+    }
+
+    best_add = ImMin( best_add, Now() - start );
+
+    // Hits in an order unrelated to the storage's, like IDs looked up as windows are drawn
+    start = Now();
+
+    for( int i = 0; i < lookups; i++ ) {
+      sink += storage.GetInt( MakeID( ( int )( ( ImU32 )i * 2654435761u % ( ImU32 )count ) ), -1 );
+    }
+
+    best_hit = ImMin( best_hit, Now() - start );
+    start = Now();
+
+    for( int i = 0; i < lookups; i++ ) {
+      sink += storage.GetInt( MakeID( count + added + i ), -1 );
+    }
+
+    best_miss = ImMin( best_miss, Now() - start );
+  }
+
+  for( int n = 0; n < count + added; n++ ) {
+    if( storage.GetInt( MakeID( n ), -1 ) != n ) {
+      errors++;
+    }
+  }
+
+  printf( "  %7d IDs: build %7.2f ms, add %7.1f ns/ID, hit %6.1f ns, miss %6.1f ns, %d errors (%lld)\n", count, best_build * 1e3, best_add * 1e9 / added,
+          best_hit * 1e9 / lookups, best_miss * 1e9 / lookups, errors, ( long long )sink );
+}
+
+int main() {
+#if defined(IMGUI_USE_HASHED_STORAGE)
+  printf( "ImGuiStorage, hashed\n" );
+#else
+  printf( "ImGuiStorage, sorted\n" );
+#endif
+
+  const int counts[] = { 10000, 100000, 1000000 };
+
+  for( int count : counts ) {
+    Run( count );
+  }
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+// Renders circles, rectangles and lines with the Site::Primitives shader into
+// an offscreen GL ES 2 surface and compares every pixel with the coverage
+// Primitives::Coverage() computes on the CPU. Runs headless, e.g. under Mesa
+// llvmpipe, and fails when a pixel is off by more than 1/255.
+// Built and run on the host by `xmake check-primitives`.
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "../src/imgui/imgui.h"
+#include "../src/imgui/imgui_impl_opengl3.h"
+#include "../src/imgui/imgui_internal.h"
+#include "../src/site/primitives.h"
+
+static const int Width = 800;
+static const int Height = 600;
+
+static bool CreateContext() {
+  // Mesa picks a window system otherwise
+  setenv( "EGL_PLATFORM", "surfaceless", 0 );
+
+  EGLDisplay display = eglGetDisplay( EGL_DEFAULT_DISPLAY );
+
+  if( display == EGL_NO_DISPLAY || !eglInitialize( display, nullptr, nullptr ) ) {
+    return false;
+  }
+
+  const EGLint configAttribs[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+                                   EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8, EGL_NONE };
+  EGLConfig config;
+  EGLint configs = 0;
+
+  if( !eglChooseConfig( display, configAttribs, &config, 1, &configs ) || configs == 0 ) {
+    return false;
+  }
+
+  const EGLint surfaceAttribs[] = { EGL_WIDTH, Width, EGL_HEIGHT, Height, EGL_NONE };
+  const EGLint contextAttribs[] = { EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE };
+  EGLSurface surface = eglCreatePbufferSurface( display, config, surfaceAttribs );
+  eglBindAPI( EGL_OPENGL_ES_API );
+  EGLContext context = eglCreateContext( display, config, EGL_NO_CONTEXT, contextAttribs );
+
+  return surface != EGL_NO_SURFACE && context != EGL_NO_CONTEXT && eglMakeCurrent( display, surface, surface, context );
+}
+
+int main() {
+  if( !CreateContext() ) {
+    fprintf( stderr, "ERROR: can't create an offscreen GL ES 2 context\n" );
+    return 1;
+  }
+
+  ImGui::CreateContext();
+  ImGuiIO &io = ImGui::GetIO();
+  io.DisplaySize = ImVec2( ( float )Width, ( float )Height );
+  io.IniFilename = NULL;
+  ImGui_ImplOpenGL3_Init( "#version 100" );
+
+  // White on black and apart from each other, so a pixel's green is the coverage of one shape
+  typedef Site::Primitives::Kind Kind;
+  const Site::Primitives::Shape shapes[] = {
+    { ImVec2( 100.0f, 100.0f ), ImVec2( 50.0f, 0.0f ), 0.0f, IM_COL32_WHITE, Kind::Circle },
+    { ImVec2( 250.3f, 100.0f ), ImVec2( 40.0f, 0.0f ), 4.0f, IM_COL32_WHITE, Kind::Circle },
+    { ImVec2( 150.0f, 500.0f ), ImVec2( 2.5f, 0.0f ), 0.0f, IM_COL32_WHITE, Kind::Circle },
+    { ImVec2( 350.0f, 60.0f ), ImVec2( 450.0f, 140.0f ), 0.0f, IM_COL32_WHITE, Kind::Rect },
+    { ImVec2( 500.5f, 60.25f ), ImVec2( 600.0f, 140.0f ), 3.0f, IM_COL32_WHITE, Kind::Rect },
+    { ImVec2( 50.0f, 250.0f ), ImVec2( 300.0f, 400.0f ), 3.0f, IM_COL32_WHITE, Kind::Line },
+    { ImVec2( 350.0f, 250.0f ), ImVec2( 600.0f, 250.0f ), 1.0f, IM_COL32_WHITE, Kind::Line },
+    { ImVec2( 650.0f, 300.0f ), ImVec2( 760.0f, 580.0f ), 7.5f, IM_COL32_WHITE, Kind::Line },
+  };
+
+  Site::Primitives primitives;
+  ImGui_ImplOpenGL3_NewFrame();
+  ImGui::NewFrame();
+
+  // ImGui::Render() skips the background list unless it holds vertices, callbacks don't count
+  ImDrawList *drawList = ImGui::GetBackgroundDrawList();
+  drawList->AddRectFilled( ImVec2( 0.0f, 0.0f ), io.DisplaySize, IM_COL32_BLACK );
+
+  for( const auto &shape : shapes ) {
+    switch( shape.mKind ) {
+      case Kind::Circle:
+        primitives.Circle( shape.mA, shape.mB.x, shape.mColor, shape.mThickness );
+        break;
+
+      case Kind::Rect:
+        primitives.Rect( shape.mA, shape.mB, shape.mColor, shape.mThickness );
+        break;
+
+      case Kind::Line:
+        primitives.Line( shape.mA, shape.mB, shape.mColor, shape.mThickness );
+        break;
+    }
+  }
+
+  primitives.Flush( drawList );
+  ImGui::Render();
+
+  if( primitives.IsTessellated() ) {
+    fprintf( stderr, "ERROR: the shape shader didn't build\n" );
+    return 1;
+  }
+
+  glViewport( 0, 0, Width, Height );
+  glClearColor( 0.0f, 0.0f, 0.0f, 1.0f );
+  glClear( GL_COLOR_BUFFER_BIT );
+  ImGui_ImplOpenGL3_RenderDrawData( ImGui::GetDrawData() );
+
+  std::vector<unsigned char> pixels( Width * Height * 4 );
+  glReadPixels( 0, 0, Width, Height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data() );
+
+  int maxDiff = 0, covered = 0;
+  double sumDiff = 0.0;
+
+  for( int y = 0; y < Height; ++y ) {
+    for( int x = 0; x < Width; ++x ) {
+      float coverage = 0.0f;
+
+      for( const auto &shape : shapes ) {
+        coverage = ImMax( coverage, Site::Primitives::Coverage( shape, ImVec2( x + 0.5f, y + 0.5f ) ) );
+      }
+
+      int expected = ( int )lroundf( coverage * 255.0f );
+      int got = pixels[( ( Height - 1 - y ) * Width + x ) * 4 + 1];
+      int diff = abs( expected - got );
+      maxDiff = ImMax( maxDiff, diff );
+      sumDiff += diff;
+      covered += expected != 0;
+    }
+  }
+
+  printf( "%s\n", ( const char * )glGetString( GL_RENDERER ) );
+  printf( "%d pixels covered, max difference %d/255, mean %.4f/255\n", covered, maxDiff, sumDiff / ( Width * Height ) );
+
+  ImGui_ImplOpenGL3_Shutdown();
+  ImGui::DestroyContext();
+  return maxDiff > 1;
+}
@@ -21,6 +21,8 @@ target("imgui")
 	add_files("./src/imgui/*.cpp")
 
 	add_defines("DIMGUI_DISABLE_FILE_FUNCTIONS")
+	-- vectorized line tessellation
+	add_cxflags("-msimd128")
 	add_cxflags("-s USE_SDL=2")
 	add_ldflags("-s USE_SDL=2")
 
@@ -55,4 +57,101 @@ target("toy")
 		os.execv("emrun", {target:targetfile()})
 	end)
 
+-- times AddPolyline() with and without the SIMD passes, on the host
+task("bench-polyline")
+	on_run(function ()
+		os.mkdir("build")
+		local sources = "src/imgui/imgui.cpp src/imgui/imgui_draw.cpp src/imgui/imgui_widgets.cpp"
+		os.exec("c++ -std=c++17 -O2 tools/bench_polyline.cpp " .. sources .. " -o build/bench_polyline")
+		os.exec("c++ -std=c++17 -O2 -DIMGUI_DISABLE_SIMD tools/bench_polyline.cpp " .. sources .. " -o build/bench_polyline_scalar")
+		os.exec("build/bench_polyline")
+		os.exec("build/bench_polyline_scalar")
+	end)
+
+	set_menu {
+		usage = "xmake bench-polyline",
+		description = "Benchmark AddPolyline() with and without IMGUI_DISABLE_SIMD"
+	}
+
+-- times auto-tessellated beziers against the recursive subdivision, on the host
+task("bench-bezier")
+	on_run(function ()
+		os.mkdir("build")
+		os.exec("c++ -std=c++17 -O2 tools/bench_bezier.cpp src/imgui/imgui.cpp src/imgui/imgui_draw.cpp src/imgui/imgui_widgets.cpp -o build/bench_bezier")
+		os.exec("build/bench_bezier")
+	end)
+
+	set_menu {
+		usage = "xmake bench-bezier",
+		description = "Benchmark forward-differenced beziers against recursive subdivision"
+	}
+
+-- regenerates src/site/font_atlas.cpp with the host compiler
+task("bake-font")
+	on_run(function ()
+		os.mkdir("build")
+		os.exec("c++ -std=c++17 -O2 tools/bake_font_atlas.cpp src/imgui/imgui.cpp src/imgui/imgui_draw.cpp src/imgui/imgui_widgets.cpp -o build/bake_font_atlas")
+		os.exec("build/bake_font_atlas src/site/font_atlas.cpp")
+	end)
+
+	set_menu {
+		usage = "xmake bake-font",
+		description = "Bake the default font atlas into src/site/font_atlas.cpp"
+	}
+
+-- measures the upload saved by compact vertices and the time spent packing them, on the host
+task("bench-vertices")
+	on_run(function ()
+		os.mkdir("build")
+		os.exec("c++ -std=c++17 -O2 tools/bench_vertices.cpp src/imgui/imgui.cpp src/imgui/imgui_draw.cpp src/imgui/imgui_widgets.cpp -lGL -o build/bench_vertices")
+		os.exec("build/bench_vertices")
+	end)
+
+	set_menu {
+		usage = "xmake bench-vertices",
+		description = "Benchmark packing compact vertices and the bytes they save"
+	}
+
+-- times ImHashStr() and ImHashData() against the byte at a time CRC32 loop, on the host
+task("bench-hash")
+	on_run(function ()
+		os.mkdir("build")
+		os.exec("c++ -std=c++17 -O2 tools/bench_hash.cpp src/imgui/imgui.cpp src/imgui/imgui_draw.cpp src/imgui/imgui_widgets.cpp -o build/bench_hash")
+		os.exec("build/bench_hash")
+	end)
+
+	set_menu {
+		usage = "xmake bench-hash",
+		description = "Benchmark hashing widget IDs and data blocks"
+	}
+
+-- times ImGuiStorage sorted and hashed with 10k to 1M IDs, on the host
+task("bench-storage")
+	on_run(function ()
+		os.mkdir("build")
+		local sources = "src/imgui/imgui.cpp src/imgui/imgui_draw.cpp src/imgui/imgui_widgets.cpp"
+		os.exec("c++ -std=c++17 -O2 tools/bench_storage.cpp " .. sources .. " -o build/bench_storage")
+		os.exec("c++ -std=c++17 -O2 -DIMGUI_USE_HASHED_STORAGE tools/bench_storage.cpp " .. sources .. " -o build/bench_storage_hashed")
+		os.exec("build/bench_storage")
+		os.exec("build/bench_storage_hashed")
+	end)
+
+	set_menu {
+		usage = "xmake bench-storage",
+		description = "Benchmark ImGuiStorage with and without IMGUI_USE_HASHED_STORAGE"
+	}
+
+-- renders the shapes of Site::Primitives offscreen and compares them with Coverage(), on the host
+task("check-primitives")
+	on_run(function ()
+		os.mkdir("build")
+		os.exec("c++ -std=c++17 -O2 -DIMGUI_IMPL_OPENGL_ES2 tools/check_primitives.cpp src/imgui/imgui.cpp src/imgui/imgui_draw.cpp src/imgui/imgui_widgets.cpp src/imgui/imgui_impl_opengl3.cpp src/site/primitives.cpp -lEGL -lGLESv2 -o build/check_primitives")
+		os.exec("build/check_primitives")
+	end)
+
+	set_menu {
+		usage = "xmake check-primitives",
+		description = "Check the shape shader against its CPU reference"
+	}
+
 --[[O-O]]--